@@ -1,9 +1,13 @@
+#include <stddef.h>
 #include "stm32f4xx.h"
 #include "arginfo.h"
 #include "flash_layout.h"
+#include "crc32.h"
 
 
 #define ARGINFO_MAGIC       0x1A2B3C4D
+#define DIGEST_MAGIC        0x32414853      // "SHA2"
+#define MANIFEST_MAGIC      0x4E414D42      // "BMAN"
 
 
 bool bl_arginfo_read(uint32_t *size, uint32_t *crc)
@@ -26,4 +30,81 @@ bool bl_arginfo_read(uint32_t *size, uint32_t *crc)
     }
 
     return true;
+}
+
+/**
+ * @brief 取出arginfo中的固件SHA-256摘要
+ * 
+ * @param digest 
+ * @return true 存在摘要
+ * @return false 上位机未写入摘要
+ */
+bool bl_arginfo_digest(uint8_t digest[ARGINFO_DIGEST_SIZE])
+{
+    uint32_t *arginfo = (uint32_t *)FLASH_ARG_ADDRESS;
+
+    if (arginfo[0] != ARGINFO_MAGIC || arginfo[3] != DIGEST_MAGIC)
+    {
+        return false;
+    }
+
+    uint8_t *sha256 = (uint8_t *)&arginfo[4];
+    for (uint32_t i = 0; i < ARGINFO_DIGEST_SIZE; i++)
+    {
+        digest[i] = sha256[i];
+    }
+
+    return true;
+}
+
+/**
+ * @brief 取出分块CRC清单，清单须与arginfo记录的固件大小、CRC相符且自身校验通过
+ * 
+ * @return const bl_manifest_t* 清单不存在或无效时返回NULL
+ */
+const bl_manifest_t *bl_arginfo_manifest(void)
+{
+    const bl_manifest_t *manifest = (const bl_manifest_t *)FLASH_MANIFEST_ADDRESS;
+    uint32_t size, image_crc;
+
+    if (!bl_arginfo_read(&size, &image_crc) || manifest->magic != MANIFEST_MAGIC)
+    {
+        return NULL;
+    }
+
+    // 块大小须为2的幂，块数须恰好覆盖整个固件
+    uint32_t block_size = manifest->block_size;
+    if (block_size < MANIFEST_BLOCK_SIZE_MIN || block_size > FLASH_APP_SIZE ||
+        (block_size & (block_size - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    if (manifest->block_count > MANIFEST_BLOCK_MAX ||
+        manifest->block_count != (size + block_size - 1) / block_size)
+    {
+        return NULL;
+    }
+
+    uint32_t crc = crc32_update(0, (uint8_t *)manifest->block_crc, manifest->block_count * sizeof(uint32_t));
+    if (crc != manifest->table_crc)
+    {
+        return NULL;
+    }
+
+    // 由各块CRC拼接出整个固件的CRC，与arginfo比对，无需读取固件本身
+    crc = 0;
+    for (uint32_t i = 0; i < manifest->block_count; i++)
+    {
+        uint32_t offset = i * block_size;
+        uint32_t len = size - offset < block_size ? size - offset : block_size;
+        crc = crc32_combine(crc, manifest->block_crc[i], len);
+    }
+
+    if (crc != image_crc)
+    {
+        return NULL;
+    }
+
+    return manifest;
 }
\ No newline at end of file
@@ -4,9 +4,43 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "flash_layout.h"
+
+
+#define ARGINFO_DIGEST_SIZE         32
+#define MANIFEST_BLOCK_SIZE_MIN     1024ul
+#define MANIFEST_BLOCK_MAX          (FLASH_APP_SIZE / MANIFEST_BLOCK_SIZE_MIN)
+
+
+/* arginfo记录，由上位机写入FLASH_ARG_ADDRESS
+ *
+ * | magic | size | crc | digest_magic | sha256 |
+ * | u32   | u32  | u32 | u32          | u8*32  |
+ *
+ * digest_magic与sha256可选，缺省时只做CRC校验
+ */
+
+/* 分块CRC清单，由上位机写入FLASH_MANIFEST_ADDRESS
+ *
+ * | magic | block_size | block_count | table_crc | block_crc[block_count] |
+ * | u32   | u32        | u32         | u32       | u32 * n                |
+ *
+ * block_crc[i]为固件第i块的CRC32，最后一块按实际剩余长度计算
+ * table_crc为block_crc[]整张表的CRC32
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t table_crc;
+    uint32_t block_crc[];
+} bl_manifest_t;
 
 
 bool bl_arginfo_read(uint32_t *size, uint32_t *crc);
+bool bl_arginfo_digest(uint8_t digest[ARGINFO_DIGEST_SIZE]);
+const bl_manifest_t *bl_arginfo_manifest(void);
 
 
 #endif /* __ARGINFO_H */
\ No newline at end of file
@@ -1,16 +1,24 @@
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include "led.h"
 #include "button.h"
 #include "main.h"
 #include "flash_layout.h"
 #include "uart.h"
 #include "ringbuffer8.h"
+#include "ringqueue.h"
 #include "boot.h"
 #include "crc32.h"
+#include "sha256.h"
 #include "norflash.h"
 #include "arginfo.h"
+#include "secure.h"
+#include "share.h"
+#include "clock.h"
+#include "event.h"
 
 
 #define LOG_TAG     "boot"
@@ -18,12 +26,31 @@
 #include "elog.h"
 
 
-static ringbuffer8_t serial_rb;                             // rb8实例
-static uint8_t serial_rb_buffer[BL_UART_BUFFER_SIZE];       // rbB的缓存数组
-static bl_ctrl_t bl_ctrl;                                   // bl控制块
-static uint32_t last_pkt_time;                              // 上一次收到一帧数据包的MS数
+// 只由CPU访问的缓存放在CCM的.ccmnoinit，启动时不清零，由bootloader_main显式初始化
+// 主SRAM留给DMA可访问的缓存，放在.noinit
+#define BL_CCM_NOINIT   __attribute__((section(".ccmnoinit")))
+#define BL_NOINIT       __attribute__((section(".noinit")))
 
-void boot_application(void);
+static ringbuffer8_t serial_rb;                             // rb8实例
+static uint8_t serial_rb_buffer[RB8_BUFFER_SIZE(BL_UART_BUFFER_SIZE)] __attribute__((aligned(4))) BL_CCM_NOINIT;   // rbB的缓存数组
+static bl_ctrl_t bl_ctrl BL_CCM_NOINIT;                     // bl控制块
+
+// 数据包缓冲池，解析器从空闲队列取包，收满后放入就绪队列，处理完归还空闲队列
+RQ_DEFINE(bl_pkt_queue, bl_pkt_t *, BL_PKT_POOL_DEPTH)
+static bl_pkt_t bl_pkt_pool[BL_PKT_POOL_DEPTH] BL_NOINIT;
+static bl_pkt_queue_t bl_pkt_free;
+static bl_pkt_queue_t bl_pkt_ready;
+
+// 包头与线路格式一致；写入的数据区按16字节对齐，FLASH可直接从数据包按字编程
+_Static_assert(sizeof(bl_pkt_head_t) == 4, "bl_pkt_head_t must match the wire header");
+_Static_assert(offsetof(bl_pkt_t, param) == 8, "bl_pkt_t param must start at offset 8");
+_Static_assert((offsetof(bl_pkt_t, param) + offsetof(bl_write_param_t, data)) % 16 == 0,
+               "write data must be 16-byte aligned");
+static uint32_t last_pkt_time;                              // 空闲或上一次收到数据时的MS数，用于帧接收超时
+static bool app_verified;                                   // 上次校验通过后FLASH未被擦写
+
+static void bl_boot_image(uint32_t addr);
+static bool bl_rx_pump(void);
 
 /**
  * @brief 串口接收回调函数，将接收到的数据放入rb8
@@ -34,6 +61,7 @@ void boot_application(void);
 static void serial_recv_callback(uint8_t *data, uint32_t len)
 {
     rb8_puts(serial_rb, data, len);
+    bl_event_set(BL_EVENT_RX);
 }
 
 /**
@@ -72,17 +100,37 @@ static void bl_response_ack(bl_op_t opcode, bl_err_t err)
 }
 
 /**
- * @brief 重置状态机和数据缓存器
+ * @brief 重置状态机和数据缓存器，未收完的数据包归还缓冲池
  * 
  * @param ctrl 
  */
 static void bl_reset(bl_ctrl_t* ctrl)
 {
-    ctrl->pkt.index = 0;
+    if (ctrl->pkt != NULL)
+    {
+        bl_pkt_queue_push(&bl_pkt_free, &ctrl->pkt);
+        ctrl->pkt = NULL;
+    }
     ctrl->rx.index = 0;
     ctrl->sm = BL_SM_STATR;
 }
 
+/**
+ * @brief 初始化数据包缓冲池，全部缓冲放入空闲队列
+ * 
+ */
+static void bl_pkt_pool_init(void)
+{
+    bl_pkt_queue_init(&bl_pkt_free);
+    bl_pkt_queue_init(&bl_pkt_ready);
+
+    for (uint32_t i = 0; i < BL_PKT_POOL_DEPTH; i++)
+    {
+        bl_pkt_t *pkt = &bl_pkt_pool[i];
+        bl_pkt_queue_push(&bl_pkt_free, &pkt);
+    }
+}
+
 /**
  * @brief 
  * 
@@ -92,17 +140,42 @@ static void bl_reset(bl_ctrl_t* ctrl)
  */
 static bool bl_pkt_crc_verify(bl_pkt_t* pkt)
 {
-    const uint8_t header = BL_PACKET_HEADER;
     uint32_t crc = 0;
 
-    crc = crc32_update(crc, (uint8_t *)&header, 1);
-    crc = crc32_update(crc, (uint8_t *)&pkt->opcode, 1);
-    crc = crc32_update(crc, (uint8_t *)&pkt->length, 2);
-    crc = crc32_update(crc, pkt->param, pkt->length);
+    crc = crc32_update(crc, (uint8_t *)&pkt->head, sizeof(pkt->head));
+    crc = crc32_update(crc, pkt->param, pkt->head.length);
 
     return crc == pkt->crc;
 }
 
+/**
+ * @brief PARAM阶段直接从rb8的连续区拷贝到数据包，不再逐字节进入状态机
+ * 
+ * @param ctrl bl控制块结构体
+ * @param rb 
+ */
+static void bl_recv_param(bl_ctrl_t *ctrl, ringbuffer8_t rb)
+{
+    bl_pkt_t *pkt = ctrl->pkt;
+    uint8_t *span;
+    uint32_t n;
+
+    while (ctrl->sm == BL_SM_PARAM && (n = rb8_peek_span(rb, &span)) != 0)
+    {
+        uint32_t remain = pkt->head.length - ctrl->index;
+        if (n > remain) n = remain;
+
+        memcpy(&pkt->param[ctrl->index], span, n);
+        ctrl->index += n;
+        rb8_consume(rb, n);
+
+        if (ctrl->index == pkt->head.length)
+        {
+            ctrl->sm = BL_SM_CRC;
+        }
+    }
+}
+
 /**
  * @brief 五阶段状态机解析数据操作
  * 
@@ -116,7 +189,7 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
     bool fullpkt = false;
 
     bl_rx_t *rx = &ctrl->rx;
-    bl_pkt_t *pkt = &ctrl->pkt;
+    bl_pkt_t *pkt = ctrl->pkt;
 
     rx->data[rx->index++] = data;
 
@@ -127,8 +200,9 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
             log_d("sm start");
 
             rx->index = 0;
-            if (rx->data[0] == 0xAA)
+            if (rx->data[0] == BL_PACKET_HEADER)
             {
+                ctrl->head.sync = rx->data[0];
                 ctrl->sm = BL_SM_OPCODE;
             }
             break;
@@ -138,7 +212,7 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
             log_d("sm opcode");
 
             rx->index = 0;
-            pkt->opcode = rx->data[0];
+            ctrl->head.opcode = rx->data[0];
             ctrl->sm = BL_SM_LENGTH;
 
             break;  
@@ -150,31 +224,37 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
             if (rx->index == 2)
             {
                 rx->index = 0;
-                uint16_t length = *(uint16_t*)rx->data;
+                uint16_t length;
+                memcpy(&length, rx->data, sizeof(length));
                 
-                if (length <= BL_PACKET_PAYLOAD_SIZE)
-                {
-                    pkt->length = length;
-                    if (length == 0) ctrl->sm = BL_SM_CRC;
-                    else ctrl->sm = BL_SM_PARAM;
-                }
-                else
+                if (length > BL_PACKET_PAYLOAD_SIZE)
                 {
                     // 给出错误响应
                     log_e("param length overflow");
-                    bl_response_ack(pkt->opcode, BL_ERR_OVERFLOW);
+                    bl_response_ack(ctrl->head.opcode, BL_ERR_OVERFLOW);
                     bl_reset(ctrl);
                 }
+                else
+                {
+                    // bl_rx_pump只在空闲队列非空时开始解析新帧，此处必能取到缓冲
+                    bl_pkt_queue_pop(&bl_pkt_free, &ctrl->pkt);
+                    ctrl->head.length = length;
+                    ctrl->index = 0;
+                    pkt = ctrl->pkt;
+                    pkt->head = ctrl->head;
+                    if (length == 0) ctrl->sm = BL_SM_CRC;
+                    else ctrl->sm = BL_SM_PARAM;
+                }
             }
             break;
         }
         case BL_SM_PARAM:
         {
             rx->index = 0;
-            if (pkt->index < pkt->length)
+            if (ctrl->index < pkt->head.length)
             {
-                pkt->param[pkt->index++] = rx->data[0];
-                if (pkt->index == pkt->length)
+                pkt->param[ctrl->index++] = rx->data[0];
+                if (ctrl->index == pkt->head.length)
                 {
                     ctrl->sm = BL_SM_CRC;
                 }
@@ -183,7 +263,7 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
             {
                 // 给出错误响应
                 log_w("no need receive param");
-                bl_response_ack(pkt->opcode, BL_ERR_PARAM);
+                bl_response_ack(pkt->head.opcode, BL_ERR_PARAM);
                 bl_reset(ctrl);
             }
             break;
@@ -193,16 +273,19 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
             if (rx->index == 4)
             {
                 rx->index = 0;
-                pkt->crc = *(uint32_t*)rx->data;
+                memcpy(&pkt->crc, rx->data, sizeof(pkt->crc));
                 // crc校验
                 if (bl_pkt_crc_verify(pkt))
                 {
+                    bl_pkt_queue_push(&bl_pkt_ready, &ctrl->pkt);
+                    ctrl->pkt = NULL;
+                    bl_reset(ctrl);
                     fullpkt = true;
                 }
                 else
                 {
                     log_e("crc mismatch");
-                    bl_response_ack(pkt->opcode, BL_ERR_VERIFY);
+                    bl_response_ack(pkt->head.opcode, BL_ERR_VERIFY);
                     bl_reset(ctrl);
                 }
             }
@@ -211,7 +294,7 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
         default:
         {
             log_e("opcode error");
-            bl_response_ack(pkt->opcode, BL_ERR_OPCODE);
+            bl_response_ack(ctrl->head.opcode, BL_ERR_OPCODE);
             bl_reset(ctrl);
             break;
         } 
@@ -220,6 +303,84 @@ static bool bl_recv_handler(bl_ctrl_t *ctrl, uint8_t data)
     return fullpkt;
 }
 
+/**
+ * @brief 解析rb8中已收到的全部数据，收满的数据包放入就绪队列；
+ *        主循环和耗时操作的间隙调用，使处理当前数据包时下一帧可以继续接收
+ * 
+ * @return true 空闲状态下收到了同步字节
+ * @return false 
+ */
+static bool bl_rx_pump(void)
+{
+    bool sync = false;
+    uint8_t data = 0;
+
+    // 参数段整块拷贝，其余逐字节处理
+    while (1)
+    {
+        bl_recv_param(&bl_ctrl, serial_rb);
+
+        // 缓冲池耗尽时不开始解析新帧，数据留在rb8中，待数据包处理完归还后继续
+        if (bl_ctrl.sm == BL_SM_STATR && bl_pkt_queue_empty(&bl_pkt_free))
+        {
+            break;
+        }
+        if (!rb8_get(serial_rb, &data))
+        {
+            break;
+        }
+
+        log_d("recv: %02X", data);
+        if (bl_ctrl.sm == BL_SM_STATR && data == BL_PACKET_HEADER)
+        {
+            sync = true;
+        }
+        bl_recv_handler(&bl_ctrl, data);
+    }
+
+    return sync;
+}
+
+/**
+ * @brief 接收是否空闲：没有待解析的字节、未收完的帧和待处理的数据包
+ * 
+ * 只能反映已进入rb8的数据，串口移位寄存器中正在接收的一字节无法得知
+ * 
+ * @return true 
+ * @return false 
+ */
+static bool bl_rx_idle(void)
+{
+    return rb8_empty(serial_rb) && bl_ctrl.sm == BL_SM_STATR && bl_ctrl.rx.index == 0 &&
+           bl_pkt_queue_empty(&bl_pkt_ready);
+}
+
+/**
+ * @brief 依次在各FLASH加速配置下对APP区做CRC，测量周期数，结束后恢复全开配置
+ * 
+ * @param bench 
+ */
+static void bl_crc_bench(bl_crc_bench_t *bench)
+{
+    // 首次调用会建表，先排除在计时之外
+    crc32_update(0, NULL, 0);
+
+    bench->core_clock = SystemCoreClock;
+    bench->latency = bl_flash_latency(SystemCoreClock);
+    bench->bytes = BL_CRC_BENCH_SIZE;
+    for (uint32_t i = 0; i < BL_FLASH_PROFILE_MAX; i++)
+    {
+        bl_flash_profile_apply((bl_flash_profile_t)i);
+
+        uint32_t start = bl_cycles();
+        crc32_update(0, (uint8_t *)FLASH_APP_ADDRESS, BL_CRC_BENCH_SIZE);
+        bench->cycles[i] = bl_cycles() - start;
+
+        log_i("crc bench profile %u: %u cycles", i, bench->cycles[i]);
+    }
+    bl_flash_profile_apply(BL_FLASH_PROFILE_FULL);
+}
+
 /**
  * @brief 查询版本号和最大传输单元操作
  * 
@@ -249,10 +410,58 @@ static void bl_op_inquiry_handler(uint8_t *data, uint16_t len)
         }
         case BL_INQUIRY_MTU:
         {
-            uint16_t mtu = BL_PACKET_PAYLOAD_SIZE;
+            bl_mtu_t mtu = { BL_PACKET_PAYLOAD_SIZE, BL_PKT_POOL_DEPTH };
             bl_response(BL_OP_INQUIRY, (uint8_t*)&mtu, sizeof(mtu));
             break;
         }
+        case BL_INQUIRY_EVENT_STATS:
+        {
+            bl_event_stats_t stats;
+            bl_event_stats(&stats);
+            bl_response(BL_OP_INQUIRY, (uint8_t*)&stats, sizeof(stats));
+            break;
+        }
+        case BL_INQUIRY_RB_STATS:
+        case BL_INQUIRY_RB_STATS_CLEAR:
+        {
+            bl_rb_stats_t stats;
+            rb8_stats(serial_rb, &stats.rx);
+            rb8_stats(bl_uart_tx_ring(), &stats.tx);
+
+            if (inquiry->subcode == BL_INQUIRY_RB_STATS_CLEAR)
+            {
+                // 接收缓冲区由中断写入，清除时关中断
+                __disable_irq();
+                rb8_stats_clear(serial_rb);
+                __enable_irq();
+                rb8_stats_clear(bl_uart_tx_ring());
+            }
+
+            // 返回清除前的统计
+            bl_response(BL_OP_INQUIRY, (uint8_t*)&stats, sizeof(stats));
+            break;
+        }
+        case BL_INQUIRY_STACK_USAGE:
+        {
+            bl_stack_usage_t usage;
+            bl_stack_usage(&usage);
+            bl_response(BL_OP_INQUIRY, (uint8_t*)&usage, sizeof(usage));
+            break;
+        }
+        case BL_INQUIRY_CRC_BENCH:
+        {
+            bl_crc_bench_t bench;
+            bl_crc_bench(&bench);
+            bl_response(BL_OP_INQUIRY, (uint8_t*)&bench, sizeof(bench));
+            break;
+        }
+        case BL_INQUIRY_BOOT_TIMING:
+        {
+            // 停留在boot时只有校验及之前的阶段有效
+            bl_timing_t timing = BL_SHARE->timing;
+            bl_response(BL_OP_INQUIRY, (uint8_t*)&timing, sizeof(timing));
+            break;
+        }
         default:
         {
             bl_response_ack(BL_OP_INQUIRY, BL_ERR_PARAM);
@@ -269,6 +478,16 @@ static void bl_op_boot_handler(void)
 {
     log_i("boot into app");
 
+#if BL_SIGNED_BOOT
+    // 签名启动：上位机不能跳过验签直接引导
+    if (!app_verified && !verify_application())
+    {
+        log_w("application verify failed");
+        bl_response_ack(BL_OP_BOOT, BL_ERR_VERIFY);
+        return;
+    }
+#endif
+
     bl_response_ack(BL_OP_BOOT, BL_OK);
 
     boot_application();
@@ -282,6 +501,7 @@ static void bl_op_reset_handler(void)
 {
     log_i("system reset");
     bl_response_ack(BL_OP_RESET, BL_OK);
+    bl_uart_flush();
     NVIC_SystemReset();
 }
 
@@ -301,6 +521,7 @@ static void bl_op_erase_handler(uint8_t *data, uint8_t len)
     {
         log_e("length mismatch %d != %d", len, sizeof(bl_erase_param_t));
         bl_response_ack(BL_OP_ERASE, BL_ERR_PARAM);
+        return;
     }
 
     if (erase->address >= FLASH_BOOT_ADDRESS && 
@@ -312,6 +533,7 @@ static void bl_op_erase_handler(uint8_t *data, uint8_t len)
     }
 
     log_i("erase 0x%08X, size %d", erase->address, erase->size);
+    app_verified = false;
     bl_norflash_unlock();
     bl_norflash_erase(erase->address, erase->size);
     bl_norflash_lock();
@@ -336,10 +558,11 @@ static void bl_op_write_handler(uint8_t *data, uint16_t len)
     log_i("write flash");
     bl_write_param_t *write = (bl_write_param_t*)data;
 
-    if (len != sizeof(bl_write_param_t) + write->size)
+    if (len < sizeof(bl_write_param_t) || len != sizeof(bl_write_param_t) + write->size)
     {
-        log_e("length mismatch %d != %d", len, sizeof(bl_write_param_t) + write->size);
+        log_e("length mismatch %d", len);
         bl_response_ack(BL_OP_WRITE, BL_ERR_PARAM);
+        return;
     }
 
     if (write->address >= FLASH_BOOT_ADDRESS && 
@@ -352,26 +575,265 @@ static void bl_op_write_handler(uint8_t *data, uint16_t len)
 
     log_i("write 0x%08X, size: %d", write->address, write->size);
 
+    // 加密传输时只解密APP区，arginfo等参数区仍为明文
+    if (bl_secure_decrypt_enabled() &&
+        write->address >= FLASH_APP_ADDRESS && write->address < FLASH_APP_ADDRESS + FLASH_APP_SIZE &&
+        !bl_secure_decrypt(write->address, write->data, write->size))
+    {
+        bl_response_ack(BL_OP_WRITE, BL_ERR_PARAM);
+        return;
+    }
+
+    // 分块写入，块间解析已收到的数据，使下一帧在编程期间完成接收
+    app_verified = false;
     bl_norflash_unlock();
-    bl_norflash_write(write->address, write->size, write->data);
+    for (uint32_t offset = 0, n = 0; offset < write->size; offset += n)
+    {
+        n = write->size - offset < BL_WRITE_CHUNK_SIZE ? write->size - offset : BL_WRITE_CHUNK_SIZE;
+        bl_norflash_write(write->address + offset, n, write->data + offset);
+        bl_rx_pump();
+    }
     bl_norflash_lock();
 
     bl_response_ack(BL_OP_WRITE, BL_OK);
 }
 
+/**
+ * @brief 开启或关闭加密传输操作
+ * 
+ * @param data iv：初始计数块，为空时关闭加密传输
+ * @param len 
+ */
+static void bl_op_decrypt_handler(uint8_t *data, uint16_t len)
+{
+#if BL_DECRYPT
+    bl_decrypt_param_t *decrypt = (bl_decrypt_param_t *)data;
+
+    if (len == 0)
+    {
+        log_i("decrypt off");
+        bl_secure_decrypt_stop();
+        bl_response_ack(BL_OP_DECRYPT, BL_OK);
+        return;
+    }
+
+    if (len != sizeof(bl_decrypt_param_t))
+    {
+        log_e("length mismatch %d != %d", len, sizeof(bl_decrypt_param_t));
+        bl_response_ack(BL_OP_DECRYPT, BL_ERR_PARAM);
+        return;
+    }
+
+    if (!bl_secure_decrypt_start(decrypt->iv))
+    {
+        bl_response_ack(BL_OP_DECRYPT, BL_ERR_PARAM);
+        return;
+    }
+
+    log_i("decrypt on");
+    bl_response_ack(BL_OP_DECRYPT, BL_OK);
+#else
+    (void)data;
+    (void)len;
+    log_e("decrypt not supported");
+    bl_response_ack(BL_OP_DECRYPT, BL_ERR_OPCODE);
+#endif
+}
+
+/**
+ * @brief 判断一段地址是否完整落在RAM_LOAD区内
+ * 
+ * @param address 
+ * @param size 
+ * @return true 
+ * @return false 
+ */
+#if !BL_SIGNED_BOOT
+static bool bl_ram_load_range(uint32_t address, uint32_t size)
+{
+    return address >= RAM_LOAD_ADDRESS && address - RAM_LOAD_ADDRESS <= RAM_LOAD_SIZE &&
+           size <= RAM_LOAD_SIZE - (address - RAM_LOAD_ADDRESS);
+}
+
+/**
+ * @brief 判断镜像的初始栈指针是否按字对齐且位于SRAM(不含共享区)或CCM内
+ * 
+ * @param sp 
+ * @return true 
+ * @return false 
+ */
+static bool bl_ram_stack_valid(uint32_t sp)
+{
+    if (sp % 4 != 0)
+    {
+        return false;
+    }
+
+    // 满递减栈，初始值可以等于区域末端
+    return (sp > SRAM1_BASE && sp <= RAM_LOAD_ADDRESS + RAM_LOAD_SIZE) ||
+           (sp > CCMDATARAM_BASE && sp <= CCMDATARAM_BASE + 64 * 1024);
+}
+#endif
+
+/**
+ * @brief 下载镜像到RAM操作，不擦写FLASH；签名启动时不支持，避免绕过验签运行任意代码
+ * 
+ * @param data 写地址+数据大小+数据，格式与写FLASH相同
+ * @param len 
+ */
+static void bl_op_ram_load_handler(uint8_t *data, uint16_t len)
+{
+#if !BL_SIGNED_BOOT
+    bl_write_param_t *load = (bl_write_param_t*)data;
+
+    if (len < sizeof(bl_write_param_t) || len != sizeof(bl_write_param_t) + load->size)
+    {
+        log_e("length mismatch %d", len);
+        bl_response_ack(BL_OP_RAM_LOAD, BL_ERR_PARAM);
+        return;
+    }
+
+    if (!bl_ram_load_range(load->address, load->size))
+    {
+        log_e("address: %08X out of ram load area", load->address);
+        bl_response_ack(BL_OP_RAM_LOAD, BL_ERR_PARAM);
+        return;
+    }
+
+    log_i("ram load 0x%08X, size: %d", load->address, load->size);
+    memcpy((void *)load->address, load->data, load->size);
+
+    bl_response_ack(BL_OP_RAM_LOAD, BL_OK);
+#else
+    (void)data;
+    (void)len;
+    log_e("ram load not supported");
+    bl_response_ack(BL_OP_RAM_LOAD, BL_ERR_OPCODE);
+#endif
+}
+
+/**
+ * @brief 校验RAM镜像并跳转运行；签名启动时不支持
+ * 
+ * @param data address：镜像起始地址 size：镜像大小 crc：镜像CRC32
+ * @param len 
+ */
+static void bl_op_ram_run_handler(uint8_t *data, uint16_t len)
+{
+#if !BL_SIGNED_BOOT
+    bl_ram_run_param_t *run = (bl_ram_run_param_t*)data;
+
+    if (len != sizeof(bl_ram_run_param_t))
+    {
+        log_e("length mismatch %d != %d", len, sizeof(bl_ram_run_param_t));
+        bl_response_ack(BL_OP_RAM_RUN, BL_ERR_PARAM);
+        return;
+    }
+
+    if (!bl_ram_load_range(run->address, run->size) || run->size < 8 || run->address % 512 != 0)
+    {
+        log_e("image 0x%08X, size %d invalid", run->address, run->size);
+        bl_response_ack(BL_OP_RAM_RUN, BL_ERR_PARAM);
+        return;
+    }
+
+    uint32_t crc = crc32_update(0, (uint8_t *)run->address, run->size);
+    if (crc != run->crc)
+    {
+        log_e("crc: %08X, verify: %08X", crc, run->crc);
+        bl_response_ack(BL_OP_RAM_RUN, BL_ERR_VERIFY);
+        return;
+    }
+
+    // 复位向量须指向镜像内部的Thumb代码
+    uint32_t pc = ((uint32_t *)run->address)[1];
+    if (!(pc & 1) || pc - run->address >= run->size)
+    {
+        log_e("entry 0x%08X invalid", pc);
+        bl_response_ack(BL_OP_RAM_RUN, BL_ERR_VERIFY);
+        return;
+    }
+
+    uint32_t sp = ((uint32_t *)run->address)[0];
+    if (!bl_ram_stack_valid(sp))
+    {
+        log_e("stack 0x%08X invalid", sp);
+        bl_response_ack(BL_OP_RAM_RUN, BL_ERR_VERIFY);
+        return;
+    }
+
+    log_i("run ram image at 0x%08X", run->address);
+    bl_response_ack(BL_OP_RAM_RUN, BL_OK);
+
+    bl_boot_image(run->address);
+#else
+    (void)data;
+    (void)len;
+    log_e("ram run not supported");
+    bl_response_ack(BL_OP_RAM_RUN, BL_ERR_OPCODE);
+#endif
+}
+
+/**
+ * @brief 计算固件的SHA-256，同时记录所用周期数
+ * 
+ * @param address 
+ * @param size 
+ * @param digest 
+ */
+static void bl_digest_compute(uint32_t address, uint32_t size, uint8_t *digest)
+{
+    uint32_t start = bl_cycles();
+    sha256((uint8_t *)address, size, digest);
+    uint32_t cycles = bl_cycles() - start;
+
+    log_i("sha256: %u bytes, %u cycles", size, cycles);
+    (void)cycles;
+}
+
+static bool bl_digest_equal(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+
+    for (uint32_t i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        diff |= a[i] ^ b[i];
+    }
+
+    return diff == 0;
+}
+
+/**
+ * @brief 计算固件的SHA-256并与期望值比对
+ * 
+ * @param address 
+ * @param size 
+ * @param expect 期望的摘要
+ * @return true 
+ * @return false 
+ */
+static bool bl_digest_verify(uint32_t address, uint32_t size, const uint8_t *expect)
+{
+    uint8_t digest[SHA256_DIGEST_SIZE];
+
+    bl_digest_compute(address, size, digest);
+
+    return bl_digest_equal(digest, expect);
+}
+
 /**
  * @brief 校验固件操作
  * 
- * @param data address：APP固件起始地址 size：APP固件大小 crc：APP固件校验码
+ * @param data address：APP固件起始地址 size：APP固件大小 crc：APP固件校验码 sha256：可选的SHA-256摘要
  * @param len 
  */
 static void bl_op_verify_handler(uint8_t *data, uint16_t len)
 {
     log_i("verify firmware");
 
-    bl_verify_param_t *verify = (bl_verify_param_t*)data;
+    bl_verify_digest_param_t *verify = (bl_verify_digest_param_t*)data;
 
-    if (len != sizeof(bl_verify_param_t))
+    if (len != sizeof(bl_verify_param_t) && len != sizeof(bl_verify_digest_param_t))
     {
         log_e("length mismatch %d != %d", len, sizeof(bl_verify_param_t));
         bl_response_ack(BL_OP_VERIFY, BL_ERR_PARAM);
@@ -383,15 +845,106 @@ static void bl_op_verify_handler(uint8_t *data, uint16_t len)
     uint32_t crc = crc32_update(0, (uint8_t*)verify->address, verify->size);
 
     log_i("crc: %08X, verify: %08X", crc, verify->crc);
-    if (crc == verify->crc)
+    if (crc != verify->crc)
     {
-        bl_response_ack(BL_OP_VERIFY, BL_OK);
+        bl_response_ack(BL_OP_VERIFY, BL_ERR_VERIFY);
+        return;
     }
-    else
+
+    if (len == sizeof(bl_verify_digest_param_t) &&
+        !bl_digest_verify(verify->address, verify->size, verify->sha256))
     {
+        log_e("sha256 mismatch");
         bl_response_ack(BL_OP_VERIFY, BL_ERR_VERIFY);
+        return;
+    }
+
+    bl_response_ack(BL_OP_VERIFY, BL_OK);
+}
+
+/**
+ * @brief 按分块清单校验固件，损坏的块在bitmap中置位
+ * 
+ * @param manifest 分块清单
+ * @param size     固件大小
+ * @param first    起始块
+ * @param count    校验的块范围
+ * @param stride   抽检步长，1为逐块校验
+ * @param bitmap   损坏块位图，可为NULL
+ * @return uint32_t 损坏的块数
+ */
+static uint32_t bl_manifest_verify(const bl_manifest_t *manifest, uint32_t size, uint32_t first,
+                                   uint32_t count, uint32_t stride, uint8_t *bitmap)
+{
+    uint32_t bad = 0;
+
+    for (uint32_t i = first; i < first + count; i += stride)
+    {
+        uint32_t offset = i * manifest->block_size;
+        uint32_t len = size - offset < manifest->block_size ? size - offset : manifest->block_size;
+
+        uint32_t crc = crc32_update(0, (uint8_t *)(FLASH_APP_ADDRESS + offset), len);
+        if (crc != manifest->block_crc[i])
+        {
+            log_w("block %u crc mismatch %08X != %08X", i, crc, manifest->block_crc[i]);
+            bad++;
+            if (bitmap)
+            {
+                bitmap[i / 8] |= 1 << (i % 8);
+            }
+        }
     }
 
+    return bad;
+}
+
+/**
+ * @brief 分块校验固件操作，返回损坏块位图，上位机只需重写损坏块所在的扇区
+ * 
+ * @param data first：起始块 count：校验块数，为0时校验至最后一块
+ * @param len 
+ */
+static void bl_op_verify_blocks_handler(uint8_t *data, uint16_t len)
+{
+    log_i("verify blocks");
+
+    bl_verify_blocks_param_t *param = (bl_verify_blocks_param_t *)data;
+
+    if (len != sizeof(bl_verify_blocks_param_t))
+    {
+        log_e("length mismatch %d != %d", len, sizeof(bl_verify_blocks_param_t));
+        bl_response_ack(BL_OP_VERIFY_BLOCKS, BL_ERR_PARAM);
+        return;
+    }
+
+    uint32_t size;
+    const bl_manifest_t *manifest = bl_arginfo_manifest();
+    if (manifest == NULL || !bl_arginfo_read(&size, NULL))
+    {
+        log_e("manifest invalid");
+        bl_response_ack(BL_OP_VERIFY_BLOCKS, BL_ERR_VERIFY);
+        return;
+    }
+
+    uint32_t first = param->first;
+    uint32_t count = param->count ? param->count : manifest->block_count - first;
+    if (first >= manifest->block_count || count > manifest->block_count - first)
+    {
+        log_e("block range %u+%u out of %u", first, count, manifest->block_count);
+        bl_response_ack(BL_OP_VERIFY_BLOCKS, BL_ERR_PARAM);
+        return;
+    }
+
+    static bl_verify_blocks_result_t result;
+    for (uint32_t i = 0; i < sizeof(result.bitmap); i++)
+    {
+        result.bitmap[i] = 0;
+    }
+    result.total = manifest->block_count;
+    result.bad = bl_manifest_verify(manifest, size, first, count, 1, result.bitmap);
+
+    log_i("blocks %u+%u, bad: %u", first, count, result.bad);
+    bl_response(BL_OP_VERIFY_BLOCKS, (uint8_t *)&result, 4 + (result.total + 7) / 8);
 }
 
 /**
@@ -401,17 +954,17 @@ static void bl_op_verify_handler(uint8_t *data, uint16_t len)
  */
 static void bl_pkt_handler(bl_pkt_t* pkt)
 {
-    log_i("opcode: %02X, ByteLen: %d", pkt->opcode, pkt->length);
-    switch (pkt->opcode)
+    log_i("opcode: %02X, ByteLen: %d", pkt->head.opcode, pkt->head.length);
+    switch (pkt->head.opcode)
     {
         case BL_OP_NONE:
         {
-            bl_response_ack(pkt->opcode, BL_ERR_UNKNOWN);
+            bl_response_ack(pkt->head.opcode, BL_ERR_UNKNOWN);
             break;
         }
         case BL_OP_INQUIRY:
         {
-            bl_op_inquiry_handler(pkt->param, pkt->length);
+            bl_op_inquiry_handler(pkt->param, pkt->head.length);
             break;
         }
         case BL_OP_BOOT:
@@ -426,7 +979,7 @@ static void bl_pkt_handler(bl_pkt_t* pkt)
         }
         case BL_OP_ERASE:
         {
-            bl_op_erase_handler(pkt->param, pkt->length);
+            bl_op_erase_handler(pkt->param, pkt->head.length);
             break;
         }
         case BL_OP_READ:
@@ -436,12 +989,32 @@ static void bl_pkt_handler(bl_pkt_t* pkt)
         }
         case BL_OP_WRITE:
         {
-            bl_op_write_handler(pkt->param, pkt->length);
+            bl_op_write_handler(pkt->param, pkt->head.length);
             break;
         }
         case BL_OP_VERIFY:
         {
-            bl_op_verify_handler(pkt->param, pkt->length);
+            bl_op_verify_handler(pkt->param, pkt->head.length);
+            break;
+        }
+        case BL_OP_VERIFY_BLOCKS:
+        {
+            bl_op_verify_blocks_handler(pkt->param, pkt->head.length);
+            break;
+        }
+        case BL_OP_DECRYPT:
+        {
+            bl_op_decrypt_handler(pkt->param, pkt->head.length);
+            break;
+        }
+        case BL_OP_RAM_LOAD:
+        {
+            bl_op_ram_load_handler(pkt->param, pkt->head.length);
+            break;
+        }
+        case BL_OP_RAM_RUN:
+        {
+            bl_op_ram_run_handler(pkt->param, pkt->head.length);
             break;
         }
         default:
@@ -450,61 +1023,161 @@ static void bl_pkt_handler(bl_pkt_t* pkt)
 }
 
 /**
- * @brief 清除B区所用到的外设和中断
+ * @brief 清除B区所用到的外设和中断，保留PLL和FLASH等待周期配置
  * 
  */
 void bl_lowlevel_deinit(void)
 {
+    // 等待已排队的响应发完
+    bl_uart_flush();
+
 #if DEBUG
     elog_deinit();
 #endif
 
+    __disable_irq();
+
     GPIO_DeInit(GPIOA);
     GPIO_DeInit(GPIOE);
     USART_DeInit(USART1);
     USART_DeInit(USART2);
+    EXTI_DeInit();
+    SYSCFG_DeInit();
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOE | RCC_AHB1Periph_DMA2, DISABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, DISABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1 | RCC_APB2Periph_SYSCFG, DISABLE);
 
     SysTick->CTRL = 0;
+    SysTick->LOAD = 0;
+    SysTick->VAL = 0;
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
 
-    __disable_irq();
+    // 关闭并清除全部中断线，APP开中断前不会收到boot遗留的中断
+    for (uint32_t i = 0; i < sizeof(NVIC->ICER) / sizeof(NVIC->ICER[0]); i++)
+    {
+        NVIC->ICER[i] = 0xFFFFFFFF;
+        NVIC->ICPR[i] = 0xFFFFFFFF;
+    }
 }
 
 /**
- * @brief bl跳转Application
+ * @brief 设置MSP后跳转，此后不再使用boot的栈
  * 
+ * @param sp APP初始栈顶
+ * @param pc APP复位向量
  */
-void boot_application(void)
+static void __attribute__((noreturn)) bl_jump(uint32_t sp, uint32_t pc)
 {
-    typedef void (*entry_t)(void);
+    __asm volatile(
+        "msr msp, %0\n"
+        "bx  %1\n"
+        :
+        : "r" (sp), "r" (pc)
+    );
+
+    __builtin_unreachable();
+}
 
-    uint32_t addr = FLASH_APP_ADDRESS;
+/**
+ * @brief 跳转到以向量表开头的镜像，跳转后的系统状态见bl_handoff_t
+ * 
+ * @param addr 向量表地址
+ */
+static void bl_boot_image(uint32_t addr)
+{
     uint32_t _sp = *(volatile uint32_t*)(addr + 0);
     uint32_t _pc = *(volatile uint32_t*)(addr + 4);
 
-    (void)_sp;
-    entry_t entry_app = (entry_t)_pc;
+    bl_share_stamp(BL_STAGE_LISTEN);
+    bl_lowlevel_deinit();
+    bl_share_handoff();
+    bl_share_stamp(BL_STAGE_DEINIT);
 
-    log_i("booting application at 0x%X", addr);
+    SCB->VTOR = addr;
+    __DSB();
+    __ISB();
 
-    bl_lowlevel_deinit();
+    // 所有中断线均已关闭，恢复复位时的PRIMASK状态
+    __enable_irq();
 
-    entry_app();
+    bl_jump(_sp, _pc);
+}
+
+/**
+ * @brief bl跳转Application；签名启动时未通过校验则不跳转，直接返回
+ * 
+ */
+void boot_application(void)
+{
+#if BL_SIGNED_BOOT
+    if (!app_verified && !verify_application())
+    {
+        log_w("application verify failed, refuse to boot");
+        return;
+    }
+#endif
+
+    log_i("booting application at 0x%X", FLASH_APP_ADDRESS);
+
+    bl_boot_image(FLASH_APP_ADDRESS);
 }
 
 /**
  * @brief 进入APP之前，从arginfo区取出魔幻数、A区固件大小，以及CRC校验码
  * 
+ * 签名启动时每次冷启动增加的耗时：切换PLL + 全镜像SHA-256(与固件大小成正比) + 一次P-256验签，
+ * 验签最坏约8.6M周期，168MHz下约51ms(按运算次数上界估算，见p256.c)
+ * 
  * @return true 
  * @return false 
  */
-bool verify_application(void)
+static bool bl_verify_application(void)
 {
     uint32_t size, crc;
+    uint8_t digest[ARGINFO_DIGEST_SIZE];
+
     if(!bl_arginfo_read(&size, &crc))
     {
         return false;
     }
 
+#if BL_SIGNED_BOOT
+    // 签名启动：验签对象是实际计算出的固件摘要，arginfo中的摘要只作比对
+    uint8_t actual[SHA256_DIGEST_SIZE];
+    bl_clock_full();
+    bl_digest_compute(FLASH_APP_ADDRESS, size, actual);
+
+    if (bl_arginfo_digest(digest) && !bl_digest_equal(actual, digest))
+    {
+        log_w("sha256 mismatch");
+        return false;
+    }
+
+    return bl_secure_verify(actual);
+#endif
+
+    // 存在摘要时以SHA-256为准，不再重复计算CRC
+    if (bl_arginfo_digest(digest))
+    {
+        bl_clock_full();
+        if (!bl_digest_verify(FLASH_APP_ADDRESS, size, digest))
+        {
+            log_w("sha256 mismatch");
+            return false;
+        }
+        return true;
+    }
+
+#if BL_BOOT_VERIFY_SAMPLE
+    // 存在分块清单时只抽检部分块，缩短启动时间
+    const bl_manifest_t *manifest = bl_arginfo_manifest();
+    if (manifest)
+    {
+        return bl_manifest_verify(manifest, size, 0, manifest->block_count, BL_BOOT_VERIFY_SAMPLE, NULL) == 0;
+    }
+#endif
+
     uint32_t ccrc = crc32_update(0, (uint8_t *)FLASH_APP_ADDRESS, size);    
     
     if (ccrc != crc)
@@ -517,97 +1190,149 @@ bool verify_application(void)
 }
 
 /**
- * @brief bl主循环：1、三秒倒计时引导APP，2、从rb8中逐字节取出并处理数据
+ * @brief 校验APP并记录结果，结果在下一次擦写FLASH前有效
  * 
- * @param boot_delay 
+ * @return true 
+ * @return false 
  */
-void bootloader_main(uint32_t boot_delay)
+bool verify_application(void)
+{
+    app_verified = bl_verify_application();
+
+    return app_verified;
+}
+
+/**
+ * @brief bl主循环：1、监听窗口内未收到同步字节则引导APP，2、从rb8中逐字节取出并处理数据
+ * 
+ * @param listen_ms 监听窗口，0表示一直停留在boot
+ * @param ready 接收流程就绪后主动发送BL_OP_READY
+ */
+void bootloader_main(uint32_t listen_ms, bool ready)
 {
     /*
     main_trap实现两种运行模式的切换
-    main_trap为false时，在倒计时结束后引导进入app
-    main_trap为true时，表示在倒计时期间接收到有效数据包，
+    main_trap为false时，在监听窗口结束后引导进入app
+    main_trap为true时，表示已收到一帧CRC正确的数据包，
     捕获当前状态，停止自动引导，进入持续等待和处理命令的循环
+    监听窗口内收到同步字节只把等待延长到其后BL_TIMEOUT_MS，仍没有有效帧则视为线路噪声，照常引导
     */
     bool main_trap = false;
+    bool host_sync = false;
     uint32_t main_enter_time = 0;
+    uint32_t host_sync_time = 0;
+
+    bl_ctrl.pkt = NULL;
+    bl_pkt_pool_init();
+    bl_reset(&bl_ctrl);
+
+    // 先建立rb8再注册回调，避免中断写入未初始化的缓存
+    serial_rb = rb8_new(serial_rb_buffer, sizeof(serial_rb_buffer));
 
     bl_uart_recv_cb_register(serial_recv_callback);
 
-    serial_rb = rb8_new(serial_rb_buffer, BL_UART_BUFFER_SIZE);
+    if (ready)
+    {
+        bl_response_ack(BL_OP_READY, BL_OK);
+    }
+
+    if (listen_ms > 0)
+    {
+        log_i("listen for host %d ms", listen_ms);
+    }
+
+    // 丢弃启动时按键检测期间产生的按键事件
+    bl_button_take();
 
     main_enter_time = bl_now();
     while(1)
     {
-        // 3s倒计时进入Application
-        if (boot_delay > 0 && !main_trap)
+        // 没有待处理的事件时在WFI中休眠，由串口、按键等中断唤醒；
+        // 只有监听窗口或接收超时需要计时时才等待节拍，按键消抖在SysTick中断内完成，不需要节拍唤醒主循环
+        uint32_t wait = BL_EVENT_RX | BL_EVENT_TX | BL_EVENT_BUTTON;
+        if ((listen_ms > 0 && !main_trap) || bl_ctrl.sm != BL_SM_STATR)
         {
-            static uint32_t last_time_arrived = 0;
-            uint32_t time_passed = bl_now() - main_enter_time;
-            if (last_time_arrived == 0)
-            {
-                log_i("boot in %d seconds", boot_delay);
-                last_time_arrived = 1;
-                time_passed = 1;
-            }
-            else if (time_passed / 1000 != last_time_arrived / 1000)
+            wait |= BL_EVENT_TICK;
+        }
+        uint32_t events = bl_event_wait(wait);
+
+        // 监听窗口结束仍未收到同步字节，或同步字节之后没有有效帧，引导进入Application
+        if (listen_ms > 0 && !main_trap && bl_now() - main_enter_time >= listen_ms &&
+            (!host_sync || bl_now() - host_sync_time >= BL_TIMEOUT_MS))
+        {
+            log_i("no host, skip into app");
+            boot_application();
+
+            // 签名启动时校验未通过会返回，停留在boot等待上位机
+            main_trap = true;
+        }
+
+        // 在boot模式下，短按重启，长按校验通过后引导APP
+        if (events & BL_EVENT_BUTTON)
+        {
+            uint32_t button = bl_button_take();
+            if (button & BL_BUTTON_LONG_PRESS)
             {
-                log_i("boot in %d seconds", boot_delay - time_passed / 1000);
+                log_i("boot scope button long pressed");
+                if (verify_application())
+                {
+                    boot_application();
+                }
+                log_w("application verify failed, stay in boot");
             }
-
-            if (time_passed >= boot_delay * 1000)
+            else if (button & BL_BUTTON_PRESS)
             {
-                log_i("skip into app");
-                boot_application();
+                log_i("boot scope button pressed, system reset");
+                bl_uart_flush();
+                NVIC_SystemReset();
             }
-
-            last_time_arrived = time_passed;
         }
 
-        // 在boot模式下，按下重启
-        if (bl_button_pressed())
+        // 只记录第一个同步字节的时刻，持续的噪声不能无限推迟引导
+        if (bl_rx_pump() && !main_trap && !host_sync)
         {
-            log_i("boot scope button pressed, system reset");
-            button_wait_release();
-            NVIC_SystemReset();
+            log_i("sync received, wait for a frame");
+            host_sync = true;
+            host_sync_time = bl_now();
         }
 
-        // rb为空时数据处理逻辑
-        if (rb8_empty(serial_rb))
+        bl_pkt_t *pkt;
+        while (bl_pkt_queue_pop(&bl_pkt_ready, &pkt))
         {
-            if (bl_ctrl.rx.index == 0)
+            // 进入命令模式后在首个响应前切换时钟；上位机流水发送时重设波特率会打乱后续帧，
+            // 须等到接收空闲的数据包再切换，此前以HSI处理
+            if (!bl_clock_is_full() && bl_rx_idle())
             {
-                last_pkt_time = bl_now();
+                bl_clock_full();
             }
-            else
+            if (!main_trap)
             {
-                // 若要开启DEBUG模式，则这里的超时时间需拉长，否则固件升级失败
-                if (bl_now() - last_pkt_time > BL_TIMEOUT_MS)
-                {
-                    log_w("recv timeout");
-                    #if DEBUG
-                    elog_hexdump("recv", 16, bl_ctrl.rx.data, bl_ctrl.rx.index);
-                    #endif
-                    bl_reset(&bl_ctrl);
-                }
+                log_i("host detected, stay in boot");
+                main_trap = true;
             }
-            // rb8为空则不进行后续的数据解析
-            continue;
+            bl_pkt_handler(pkt);
+            bl_pkt_queue_push(&bl_pkt_free, &pkt);
+
+            // 解析处理期间收到的数据，收满的数据包在本循环内继续处理
+            bl_rx_pump();
         }
 
-        // 数据逐字节处理
-        uint8_t data = 0;
-        rb8_get(serial_rb, &data);
-        log_d("recv: %02X", data);
-        if (bl_recv_handler(&bl_ctrl, data))
+        // 帧接收中途超过BL_TIMEOUT_MS没有新数据则丢弃该帧；参数段rx.index恒为0，须以状态机判断
+        if (bl_ctrl.sm == BL_SM_STATR || (events & BL_EVENT_RX))
         {
-            // 已接受完整的一帧数据包
-            bl_pkt_handler(&bl_ctrl.pkt);
-            bl_reset(&bl_ctrl);
-            main_trap = true;
             last_pkt_time = bl_now();
         }
-        
+        else
+        {
+            // 若要开启DEBUG模式，则这里的超时时间需拉长，否则固件升级失败
+            if (bl_now() - last_pkt_time > BL_TIMEOUT_MS)
+            {
+                log_w("recv timeout");
+                #if DEBUG
+                elog_hexdump("recv", 16, bl_ctrl.rx.data, bl_ctrl.rx.index);
+                #endif
+                bl_reset(&bl_ctrl);
+            }
+        }
     }
 }
-
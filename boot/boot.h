@@ -2,6 +2,13 @@
 #define __BOOT_H
 
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "arginfo.h"
+#include "secure.h"
+#include "clock.h"
+#include "ringbuffer8.h"
+
 /* format
  *
  * | start | opcode | length | payload | crc32 |
@@ -15,17 +22,43 @@
 
 #define BL_PACKET_HEADER            0xAA
 #define BL_UART_BUFFER_SIZE         512ul
-#define BL_PACKET_HEAD_SIZE         8ul
+#define BL_PACKET_HEAD_SIZE         8ul         // 同步字节、操作码、长度和CRC
 #define BL_PACKET_PAYLOAD_SIZE      4096ul
-#define BL_PACKET_PARAM_SIZE        BL_PACKET_HEAD_SIZE + BL_PACKET_PAYLOAD_SIZE
 #define BL_TIMEOUT_MS               500ul
+#define BL_WRITE_CHUNK_SIZE         256ul       // 写FLASH时每写入该长度解析一次已收到的数据
+
+// 数据包缓冲池深度，须为2的幂；池耗尽时暂停解析，后续数据留在串口接收缓存中，
+// 上位机未收到响应的数据包不应超过该深度(可由BL_INQUIRY_MTU查询)，超出部分只能靠BL_UART_BUFFER_SIZE暂存
+#ifndef BL_PKT_POOL_DEPTH
+#define BL_PKT_POOL_DEPTH           2ul
+#endif
+
+// 复位后监听同步字节的时间窗口，期间收到有效数据包即停留在boot，否则直接引导APP；
+// 默认与原3秒倒计时一致，兼容成品固件/Upgrader
+#ifndef BL_BOOT_LISTEN_MS
+#define BL_BOOT_LISTEN_MS           3000ul
+#endif
+
+// CRC基准测试读取的FLASH长度，从APP区起始处读取
+#define BL_CRC_BENCH_SIZE           (32ul * 1024)
+
+// 启动时的分块抽检步长：0表示全量CRC校验，n表示存在分块清单时每n块抽检一块
+#ifndef BL_BOOT_VERIFY_SAMPLE
+#define BL_BOOT_VERIFY_SAMPLE       0ul
+#endif
 
 
 // 查询码
 typedef enum
 {
     BL_INQUIRY_VERSION,
-    BL_INQUIRY_MTU
+    BL_INQUIRY_MTU,
+    BL_INQUIRY_BOOT_TIMING,
+    BL_INQUIRY_CRC_BENCH,
+    BL_INQUIRY_EVENT_STATS,
+    BL_INQUIRY_RB_STATS,
+    BL_INQUIRY_RB_STATS_CLEAR,
+    BL_INQUIRY_STACK_USAGE
 } bl_inquiry_t;
 
 // 操作码-描述一帧数据包所要执行的操作
@@ -34,11 +67,16 @@ typedef enum
     BL_OP_NONE      = 0X00,
     BL_OP_INQUIRY   = 0X10,
     BL_OP_BOOT      = 0X11,
+    BL_OP_READY     = 0X12,
     BL_OP_RESET     = 0X1F,
     BL_OP_ERASE     = 0X20,
     BL_OP_READ      = 0X21,
     BL_OP_WRITE     = 0X22,
-    BL_OP_VERIFY    = 0X23
+    BL_OP_VERIFY    = 0X23,
+    BL_OP_VERIFY_BLOCKS = 0X24,
+    BL_OP_DECRYPT   = 0X25,
+    BL_OP_RAM_LOAD  = 0X26,
+    BL_OP_RAM_RUN   = 0X27
 } bl_op_t;
 
 // 响应码
@@ -64,28 +102,37 @@ typedef enum
     BL_SM_CRC
 } bl_state_machine_t;
 
-// 一帧数据包结构体
-typedef struct 
+// 线路上的包头，字段顺序和宽度与帧格式一致，CRC可直接覆盖
+typedef struct __attribute__((packed))
 {
-    bl_op_t opcode;
+    uint8_t sync;               // BL_PACKET_HEADER
+    uint8_t opcode;             // bl_op_t
     uint16_t length;
+} bl_pkt_head_t;
+
+// 一帧数据包结构体，只保存线路上的数据，接收进度在bl_ctrl_t中
+// 按16字节对齐且param位于偏移8，带8字节地址/长度头的参数(如bl_write_param_t)其数据区也按16字节对齐
+typedef struct __attribute__((aligned(16)))
+{
+    bl_pkt_head_t head;
     uint32_t crc;
-    uint16_t index;
-    uint8_t param[BL_PACKET_PARAM_SIZE];
+    uint8_t param[BL_PACKET_PAYLOAD_SIZE];
 } bl_pkt_t;
 
-// 当前状态接收数据的结构体
+// 当前状态接收数据的结构体，最长的字段为4字节CRC
 typedef struct 
 {
+    uint8_t data[4];
     uint8_t index;
-    uint8_t data[16];
 } bl_rx_t;
 
 // bl控制块结构体
 typedef struct
 {
     bl_rx_t rx;
-    bl_pkt_t pkt;
+    bl_pkt_head_t head;         // 正在接收的包头，取得缓冲后拷入数据包
+    uint16_t index;             // 已接收的参数字节数
+    bl_pkt_t *pkt;              // 正在接收的数据包，收到长度后从缓冲池取得
     bl_state_machine_t sm;    
 } bl_ctrl_t;
 
@@ -95,6 +142,29 @@ typedef struct
     uint8_t subcode;
 } bl_inquiry_param_t;
 
+// BL_INQUIRY_MTU应答，前2字节与旧版一致；上位机未收到响应的数据包不应超过pool_depth
+typedef struct
+{
+    uint16_t mtu;                       // 单包参数最大长度
+    uint16_t pool_depth;                // BL_PKT_POOL_DEPTH
+} bl_mtu_t;
+
+// 串口收发缓冲区统计
+typedef struct
+{
+    rb8_stats_t rx;
+    rb8_stats_t tx;
+} bl_rb_stats_t;
+
+// CRC基准测试结果，MB/s = bytes * core_clock / cycles / 1e6
+typedef struct
+{
+    uint32_t core_clock;
+    uint32_t latency;                   // FLASH等待周期
+    uint32_t bytes;
+    uint32_t cycles[BL_FLASH_PROFILE_MAX];  // 按bl_flash_profile_t顺序
+} bl_crc_bench_t;
+
 // 擦除FLASH结构体
 typedef struct 
 {
@@ -118,9 +188,53 @@ typedef struct
     uint32_t crc;
 } bl_verify_param_t;
 
+// 带SHA-256摘要的校验固件结构体
+typedef struct
+{
+    uint32_t address;
+    uint32_t size;
+    uint32_t crc;
+    uint8_t sha256[ARGINFO_DIGEST_SIZE];
+} bl_verify_digest_param_t;
+
+// 分块校验结构体，count为0表示校验全部分块
+typedef struct
+{
+    uint16_t first;
+    uint16_t count;
+} bl_verify_blocks_param_t;
+
+// 分块校验结果，bitmap中第i位置1表示第i块损坏
+typedef struct
+{
+    uint16_t total;
+    uint16_t bad;
+    uint8_t bitmap[(MANIFEST_BLOCK_MAX + 7) / 8];
+} bl_verify_blocks_result_t;
+
+/* 运行RAM镜像结构体
+ *
+ * 镜像须以RAM_LOAD_ADDRESS为链接地址或为位置无关代码，且以向量表开头，
+ * address须按512字节对齐以满足VTOR要求，初始栈指针须按字对齐并位于SRAM(不含共享区)或CCM；
+ * 签名启动(BL_SIGNED_BOOT)时不支持RAM_LOAD/RAM_RUN，响应BL_ERR_OPCODE
+ */
+typedef struct
+{
+    uint32_t address;
+    uint32_t size;
+    uint32_t crc;
+} bl_ram_run_param_t;
+
+// 加密传输结构体，长度为0时关闭加密传输
+typedef struct
+{
+    uint8_t iv[SECURE_IV_SIZE];
+} bl_decrypt_param_t;
+
 
 bool verify_application(void);
-void bootloader_main(uint32_t delay_ms);
+void boot_application(void);
+void bootloader_main(uint32_t listen_ms, bool ready);
 
 
 #endif /* __BOOT_H */
\ No newline at end of file
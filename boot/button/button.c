@@ -1,6 +1,22 @@
 #include "stm32f4xx.h"
 #include "button.h"
 #include "main.h"
+#include "event.h"
+
+
+// 消抖状态机：EXTI下降沿启动，之后由1ms节拍采样，空闲时不占用节拍
+typedef enum
+{
+    BUTTON_IDLE,
+    BUTTON_DEBOUNCE,                    // 按下消抖
+    BUTTON_PRESSED,                     // 已按下，计时长按
+    BUTTON_HELD                         // 已产生长按，等待松开
+} button_state_t;
+
+static volatile button_state_t button_state;
+static uint16_t button_hold_ms;
+static uint16_t button_release_ms;
+static volatile uint32_t button_events;
 
 void bl_button_init(void)
 {
@@ -13,8 +29,28 @@ void bl_button_init(void)
     GPIO_InitStructure.GPIO_Speed = GPIO_Medium_Speed;
 
     GPIO_Init(GPIOE, &GPIO_InitStructure);
+
+    // 按下时产生下降沿，启动消抖状态机
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+    SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOE, EXTI_PinSource0);
+
+    EXTI_InitStructure.EXTI_Line = EXTI_Line0;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 }
 
+// 阻塞式检测，仅用于上电时的按键启动判断，主循环使用bl_button_take
 bool bl_button_pressed(void)
 {
     if (GPIO_ReadInputDataBit(GPIOE, GPIO_Pin_0) == Bit_RESET)
@@ -35,4 +71,99 @@ void button_wait_release(void)
     {
         bl_delay_ms(100);
     }
-}
\ No newline at end of file
+}
+
+static void button_raise(uint32_t event)
+{
+    button_events |= event;
+    bl_event_set(BL_EVENT_BUTTON);
+}
+
+/**
+ * @brief 按键消抖状态机，每1ms由SysTick中断调用，从不阻塞
+ * 
+ */
+void bl_button_tick(void)
+{
+    if (button_state == BUTTON_IDLE)
+    {
+        return;
+    }
+
+    bool low = GPIO_ReadInputDataBit(GPIOE, GPIO_Pin_0) == Bit_RESET;
+
+    switch (button_state)
+    {
+        case BUTTON_DEBOUNCE:
+        {
+            if (!low)
+            {
+                button_state = BUTTON_IDLE;
+            }
+            else if (++button_hold_ms >= BL_BUTTON_DEBOUNCE_MS)
+            {
+                button_release_ms = 0;
+                button_state = BUTTON_PRESSED;
+            }
+            break;
+        }
+        case BUTTON_PRESSED:
+        case BUTTON_HELD:
+        {
+            if (low)
+            {
+                button_release_ms = 0;
+                if (button_state == BUTTON_PRESSED && ++button_hold_ms >= BL_BUTTON_LONG_PRESS_MS)
+                {
+                    button_state = BUTTON_HELD;
+                    button_raise(BL_BUTTON_LONG_PRESS);
+                }
+            }
+            else if (++button_release_ms >= BL_BUTTON_DEBOUNCE_MS)
+            {
+                if (button_state == BUTTON_PRESSED)
+                {
+                    button_raise(BL_BUTTON_PRESS);
+                }
+                button_state = BUTTON_IDLE;
+            }
+            break;
+        }
+        default:
+        {
+            button_state = BUTTON_IDLE;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 取走已产生的按键事件
+ * 
+ * @return uint32_t BL_BUTTON_*
+ */
+uint32_t bl_button_take(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    // 调用者可能已关中断，恢复原状态而不是直接开中断
+    __disable_irq();
+    uint32_t events = button_events;
+    button_events = 0;
+    __set_PRIMASK(primask);
+
+    return events;
+}
+
+void EXTI0_IRQHandler(void)
+{
+    if (EXTI_GetITStatus(EXTI_Line0) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line0);
+        if (button_state == BUTTON_IDLE)
+        {
+            button_hold_ms = 0;
+            button_state = BUTTON_DEBOUNCE;
+        }
+    }
+}
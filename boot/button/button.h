@@ -2,10 +2,21 @@
 #define __BUTTON_H
 
 
+#include <stdint.h>
 #include <stdbool.h>
 
 
+#define BL_BUTTON_DEBOUNCE_MS       20
+#define BL_BUTTON_LONG_PRESS_MS     2000
+
+// 按键事件，由SysTick中的消抖状态机产生
+#define BL_BUTTON_PRESS             (1ul << 0)      // 短按，松开时产生
+#define BL_BUTTON_LONG_PRESS        (1ul << 1)      // 长按，按住达到BL_BUTTON_LONG_PRESS_MS时产生
+
+
 void bl_button_init(void);
+void bl_button_tick(void);
+uint32_t bl_button_take(void);
 bool bl_button_pressed(void);
 void button_wait_release(void);
 
@@ -0,0 +1,143 @@
+#include "stm32f4xx.h"
+#include "system_stm32f4xx.h"
+#include "main.h"
+#include "clock.h"
+#include "share.h"
+
+#define LOG_TAG     "clock"
+#define LOG_LVL     ELOG_LVL_INFO
+#include "elog.h"
+
+#if DEBUG
+extern ElogErrCode elog_port_init(void);
+#endif
+
+
+// FLASH等待周期最多7级，例如1.8~2.1V下168MHz需要8级，超出RM0090规格，只能降频或提高供电
+#if BL_SYSCLK_LATENCY > 7
+#error "SYSCLK needs more than 7 flash wait states at BL_VDD_MV, raise CONFIG_VDD_MV or lower the PLL clock"
+#endif
+
+
+static bl_flash_profile_t flash_profile = BL_FLASH_PROFILE_FULL;
+static uint32_t flash_cache_saved;
+static bool clock_failed;                   // HSE起振失败后不再重试，避免每次都重设串口
+
+/**
+ * @brief 当前是否已运行在PLL上
+ * 
+ * @return true 
+ * @return false 
+ */
+bool bl_clock_is_full(void)
+{
+    return (RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL;
+}
+
+/**
+ * @brief 切换到PLL全速运行，并按新时钟重设SysTick和串口波特率
+ * 
+ * 切换期间APB分频先于SYSCLK生效，串口收发会错乱，调用者须保证线路空闲；
+ * 只尝试一次，HSE起振失败后之后的调用直接返回，继续以HSI运行
+ */
+void bl_clock_full(void)
+{
+    if (bl_clock_is_full() || clock_failed)
+    {
+        return;
+    }
+
+    uint32_t start = bl_cycles();
+
+    bl_uart_flush();
+    SystemClockConfig();
+    SystemCoreClockUpdate();
+    if (!bl_clock_is_full())
+    {
+        // HSE起振失败，继续以HSI运行
+        clock_failed = true;
+        log_w("pll start failed");
+        return;
+    }
+
+    BL_SHARE->timing.pll_stamp = bl_cycles();
+
+    bl_flash_profile_apply(flash_profile);
+    bl_delay_init();
+    bl_uart_set_baudrate(bl_uart_baudrate());
+#if DEBUG
+    elog_port_init();
+#endif
+
+    log_i("pll on: %u Hz, %u cycles", SystemCoreClock, BL_SHARE->timing.pll_stamp - start);
+    (void)start;
+}
+
+/**
+ * @brief 计算HCLK所需的最小FLASH等待周期，参考RM0090 Table 10
+ * 
+ * hclk不超过BL_SYSCLK_HZ，结果不超过编译期检查过的BL_SYSCLK_LATENCY
+ * 
+ * @param hclk 
+ * @return uint32_t 
+ */
+uint32_t bl_flash_latency(uint32_t hclk)
+{
+    return (hclk - 1) / BL_FLASH_STEP_HZ;
+}
+
+/**
+ * @brief 按当前HCLK配置FLASH等待周期和ART加速器，时钟变化后须重新调用
+ * 
+ * 升频时须在切换前加大等待周期，SetSysClock已处理；此处只会保持或降低等待周期
+ * 
+ * @param profile 
+ */
+void bl_flash_profile_apply(bl_flash_profile_t profile)
+{
+    uint32_t acr = bl_flash_latency(SystemCoreClock);
+
+    if (profile != BL_FLASH_PROFILE_NONE)
+    {
+        acr |= FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+    }
+#if BL_VDD_MV >= 2100
+    // 低于2.1V时不可开启预取
+    if (profile == BL_FLASH_PROFILE_FULL)
+    {
+        acr |= FLASH_ACR_PRFTEN;
+    }
+#endif
+
+    // 缓存须在关闭状态下复位
+    FLASH->ACR = acr & FLASH_ACR_LATENCY;
+    FLASH->ACR = (acr & FLASH_ACR_LATENCY) | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR = acr;
+    while ((FLASH->ACR & FLASH_ACR_LATENCY) != (acr & FLASH_ACR_LATENCY));
+
+    flash_profile = profile;
+}
+
+/**
+ * @brief 擦写前关闭指令/数据缓存，避免缓存住擦写过程中的FLASH内容
+ * 
+ */
+void bl_flash_cache_suspend(void)
+{
+    flash_cache_saved = FLASH->ACR & (FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+    FLASH->ACR &= ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+}
+
+/**
+ * @brief 擦写后复位缓存，丢弃擦写前缓存的旧内容，再恢复原有的使能状态
+ * 
+ * 复位位只在缓存关闭时有效，须在bl_flash_cache_suspend之后调用
+ */
+void bl_flash_cache_resume(void)
+{
+    uint32_t acr = FLASH->ACR & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+
+    FLASH->ACR = acr | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR = acr;
+    FLASH->ACR = acr | flash_cache_saved;
+}
@@ -0,0 +1,59 @@
+#ifndef __CLOCK_H
+#define __CLOCK_H
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* 时钟策略
+ *
+ * BL_CLOCK_LAZY_PLL为0：SystemInit中即切换到PLL，与标准启动流程一致
+ * BL_CLOCK_LAZY_PLL为1：复位后保持HSI 16MHz，只有进入命令模式或校验需要做SHA-256/验签时
+ *                       才调用bl_clock_full切换到PLL；CRC校验通过时直接以HSI交给APP，
+ *                       APP按bl_handoff_t中记录的时钟自行配置
+ */
+#ifndef BL_CLOCK_LAZY_PLL
+#define BL_CLOCK_LAZY_PLL       0
+#endif
+
+// 供电电压，决定FLASH每级等待周期允许的HCLK、能否开启预取以及擦写的并行位宽
+#ifndef BL_VDD_MV
+#define BL_VDD_MV               3300
+#endif
+
+// PLL输出的SYSCLK(=HCLK)，须与system_stm32f4xx.c中的PLL_M/PLL_N/PLL_P一致
+#if defined(STM32F427_437xx) || defined(STM32F429_439xx)
+#define BL_SYSCLK_HZ            180000000ul
+#else
+#define BL_SYSCLK_HZ            168000000ul
+#endif
+
+// RM0090 Table 10：每增加一级FLASH等待周期允许的HCLK增量随VDD降低
+#define BL_FLASH_STEP_HZ        (BL_VDD_MV >= 2700 ? 30000000ul : \
+                                 BL_VDD_MV >= 2400 ? 24000000ul : \
+                                 BL_VDD_MV >= 2100 ? 22000000ul : 20000000ul)
+// 以BL_SYSCLK_HZ运行所需的等待周期，最多7级，clock.c在编译期检查
+#define BL_SYSCLK_LATENCY       ((BL_SYSCLK_HZ - 1) / BL_FLASH_STEP_HZ)
+
+
+// FLASH访问加速配置，等待周期始终按当前HCLK和BL_VDD_MV取最小值
+typedef enum
+{
+    BL_FLASH_PROFILE_NONE,              // 关闭预取和指令/数据缓存
+    BL_FLASH_PROFILE_CACHE,             // 只开指令/数据缓存
+    BL_FLASH_PROFILE_FULL,              // 预取+指令/数据缓存
+    BL_FLASH_PROFILE_MAX
+} bl_flash_profile_t;
+
+
+bool bl_clock_is_full(void);
+void bl_clock_full(void);
+
+uint32_t bl_flash_latency(uint32_t hclk);
+void bl_flash_profile_apply(bl_flash_profile_t profile);
+void bl_flash_cache_suspend(void);
+void bl_flash_cache_resume(void);
+
+
+#endif /* __CLOCK_H */
@@ -0,0 +1,93 @@
+#include "stm32f4xx.h"
+#include "event.h"
+
+
+#define EVENT_STAT_MASK     ((1ul << BL_EVENT_COUNT) - 1)
+
+static volatile uint32_t event_pending;
+static volatile uint32_t event_stamp[BL_EVENT_COUNT];      // 各事件从未置位变为置位时的周期数
+static bl_event_stats_t event_stats;
+
+
+/**
+ * @brief 置位事件，可在中断中调用
+ * 
+ * @param events BL_EVENT_*
+ */
+void bl_event_set(uint32_t events)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    // 只记录新置位的事件，已挂起的事件保持最早的时刻
+    uint32_t fresh = events & ~event_pending & EVENT_STAT_MASK;
+    uint32_t now = DWT->CYCCNT;
+    while (fresh)
+    {
+        event_stamp[__builtin_ctz(fresh)] = now;
+        fresh &= fresh - 1;
+    }
+    event_pending |= events;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 等待并取走mask中的事件，没有事件时以WFI休眠，其余事件保留
+ * 
+ * 关中断后检查事件再WFI，挂起的中断仍能唤醒内核，检查与休眠之间置位的事件不会丢失
+ * 
+ * @param mask 
+ * @return uint32_t 取走的事件
+ */
+uint32_t bl_event_wait(uint32_t mask)
+{
+    uint32_t events, latency[BL_EVENT_COUNT];
+
+    __disable_irq();
+    while ((event_pending & mask) == 0)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    events = event_pending & mask;
+    event_pending &= ~mask;
+
+    uint32_t now = DWT->CYCCNT;
+    for (uint32_t i = 0; i < BL_EVENT_COUNT; i++)
+    {
+        latency[i] = now - event_stamp[i];
+    }
+    __enable_irq();
+
+    // 未取走的事件不计入，待其被取走时按各自的置位时刻统计
+    for (uint32_t taken = events & EVENT_STAT_MASK; taken; taken &= taken - 1)
+    {
+        uint32_t i = __builtin_ctz(taken);
+        bl_event_stat_t *stat = &event_stats.event[i];
+
+        if (stat->wakeups == 0 || latency[i] < stat->latency_min)
+        {
+            stat->latency_min = latency[i];
+        }
+        if (latency[i] > stat->latency_max)
+        {
+            stat->latency_max = latency[i];
+        }
+        stat->latency_last = latency[i];
+        stat->latency_sum += latency[i];
+        stat->wakeups++;
+    }
+
+    return events;
+}
+
+/**
+ * @brief 读取各事件的唤醒延迟统计
+ * 
+ * @param stats 
+ */
+void bl_event_stats(bl_event_stats_t *stats)
+{
+    *stats = event_stats;
+}
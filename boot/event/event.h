@@ -0,0 +1,40 @@
+#ifndef __EVENT_H
+#define __EVENT_H
+
+
+#include <stdint.h>
+
+
+// 事件标志，由中断置位，主循环在bl_event_wait中取走
+#define BL_EVENT_RX             (1ul << 0)      // 串口收到数据
+#define BL_EVENT_TX             (1ul << 1)      // 串口发送完成
+#define BL_EVENT_FLASH          (1ul << 2)      // FLASH擦写完成
+#define BL_EVENT_TICK           (1ul << 3)      // 1ms节拍
+#define BL_EVENT_BUTTON         (1ul << 4)      // 按键
+#define BL_EVENT_COUNT          5               // 事件位数，唤醒延迟按位分别统计
+#define BL_EVENT_ALL            0xFFFFFFFF
+
+
+// 单个事件的唤醒延迟统计，延迟为该事件置位到被bl_event_wait取走的DWT周期数
+typedef struct
+{
+    uint32_t wakeups;
+    uint32_t latency_last;
+    uint32_t latency_min;
+    uint32_t latency_max;
+    uint64_t latency_sum;               // 168MHz下约3400年才回绕
+} bl_event_stat_t;
+
+// 按事件位索引，event[0]对应BL_EVENT_RX
+typedef struct
+{
+    bl_event_stat_t event[BL_EVENT_COUNT];
+} bl_event_stats_t;
+
+
+void bl_event_set(uint32_t events);
+uint32_t bl_event_wait(uint32_t mask);
+void bl_event_stats(bl_event_stats_t *stats);
+
+
+#endif /* __EVENT_H */
@@ -8,8 +8,15 @@
 #define FLASH_ARG_ADDRESS       0x0800C000
 #define FLAHS_ARG_SIZE          16 * 1024
 
+#define FLASH_SIGNATURE_ADDRESS 0x0800C100      // 固件签名尾部
+#define FLASH_MANIFEST_ADDRESS  0x0800C400      // 分块CRC清单，与arginfo同处ARG扇区
+
 #define FLASH_APP_ADDRESS       0x08010000
 #define FLASH_APP_SIZE          320 * 1024
 
+// SRAM上半部分留给RAM_LOAD下载的测试镜像，boot自身只使用下半部分，顶端256字节为boot/APP共享区
+#define RAM_LOAD_ADDRESS        0x20010000
+#define RAM_LOAD_SIZE           (64 * 1024 - 256)
+
 
 #endif /* __BL_FLASH_LAYOUT_H */
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "stm32f4xx.h"
 #include "norflash.h"
+#include "clock.h"
+#include "event.h"
 
 #define LOG_TAG     "norflash"
 #define LOG_LVL     ELOG_LVL_INFO
@@ -7,6 +9,15 @@
 
 #define FLASH_BASE_ADDR     0x08000000
 
+// 擦写并行位宽随供电电压而定，参考RM0090 Table 7
+#if BL_VDD_MV >= 2700
+#define NORFLASH_PSIZE          FLASH_PSIZE_WORD
+#elif BL_VDD_MV >= 2100
+#define NORFLASH_PSIZE          FLASH_PSIZE_HALF_WORD
+#else
+#define NORFLASH_PSIZE          FLASH_PSIZE_BYTE
+#endif
+
 typedef struct
 {
     uint32_t flash_sector;
@@ -29,6 +40,17 @@ static const sector_desc_t sector_descs[] =
     {FLASH_Sector_11, 128 * 1024},
 };
 
+void bl_norflash_init(void)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    NVIC_InitStructure.NVIC_IRQChannel = FLASH_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
 void bl_norflash_lock(void)
 {
     log_i("norflash lock");
@@ -41,15 +63,64 @@ void bl_norflash_unlock(void)
     FLASH_Unlock();
 }
 
+/**
+ * @brief 等待当前擦写操作结束，期间以WFI休眠，由EOP/ERR中断唤醒
+ * 
+ * @return FLASH_Status 
+ */
+static FLASH_Status norflash_wait(void)
+{
+    while (FLASH->SR & FLASH_FLAG_BSY)
+    {
+        bl_event_wait(BL_EVENT_FLASH);
+    }
+
+    // EOP可能先于中断被看到，先清除以免被FLASH_GetStatus当作错误
+    FLASH->SR = FLASH_FLAG_EOP;
+
+    return FLASH_GetStatus();
+}
+
+/**
+ * @brief 擦除一个扇区，与FLASH_EraseSector相同，只是等待方式改为事件唤醒
+ * 
+ * @param sector FLASH_Sector_x
+ * @return FLASH_Status 
+ */
+static FLASH_Status norflash_erase_sector(uint32_t sector)
+{
+    FLASH_Status status = norflash_wait();
+
+    if (status != FLASH_COMPLETE)
+    {
+        return status;
+    }
+
+    FLASH->CR &= ~FLASH_CR_PSIZE;
+    FLASH->CR |= NORFLASH_PSIZE;
+    FLASH->CR &= ~FLASH_CR_SNB;
+    FLASH->CR |= FLASH_CR_SER | sector;
+    FLASH->CR |= FLASH_CR_STRT;
+
+    status = norflash_wait();
+
+    FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+
+    return status;
+}
+
 void bl_norflash_erase(uint32_t address, uint32_t size)
 {
     uint32_t erase_addr = FLASH_BASE_ADDR;
+
+    bl_flash_cache_suspend();
+    FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERR, ENABLE);
     for (uint8_t i = 0; i < sizeof(sector_descs) / sizeof(sector_descs[0]); i ++)
     {
         if (erase_addr >= address && erase_addr < address + size)
         {
             log_i("erase sector%u, addr: 0x%08x, size: %u", i, erase_addr, sector_descs[i].sector_size);
-            if (FLASH_EraseSector(sector_descs[i].flash_sector, VoltageRange_3) != FLASH_COMPLETE)
+            if (norflash_erase_sector(sector_descs[i].flash_sector) != FLASH_COMPLETE)
             {
                 log_w("erase sector %u failed", i);
             }
@@ -57,10 +128,22 @@ void bl_norflash_erase(uint32_t address, uint32_t size)
 
         erase_addr += sector_descs[i].sector_size;
     }
+
+    FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERR, DISABLE);
+    bl_flash_cache_resume();
 }
 
+/**
+ * @brief 编程一段FLASH，只在编程期间关闭指令/数据缓存，调用者可在两次调用之间以缓存全速运行
+ * 
+ * @param address 
+ * @param size 
+ * @param data 
+ */
 void bl_norflash_write(uint32_t address, uint32_t size, uint8_t *data)
 {
+    bl_flash_cache_suspend();
+#if BL_VDD_MV >= 2700
     for(uint32_t i = 0; i < size; i += 4)
     {
         if (FLASH_ProgramWord(address + i, *(uint32_t*)(data + i)) != FLASH_COMPLETE)
@@ -68,5 +151,33 @@ void bl_norflash_write(uint32_t address, uint32_t size, uint8_t *data)
             log_w("write flash error, addr: 0x%08X", address + i);
         }
     }
-    
-}
\ No newline at end of file
+#elif BL_VDD_MV >= 2100
+    for(uint32_t i = 0; i < size; i += 2)
+    {
+        if (FLASH_ProgramHalfWord(address + i, *(uint16_t*)(data + i)) != FLASH_COMPLETE)
+        {
+            log_w("write flash error, addr: 0x%08X", address + i);
+        }
+    }
+#else
+    for(uint32_t i = 0; i < size; i++)
+    {
+        if (FLASH_ProgramByte(address + i, data[i]) != FLASH_COMPLETE)
+        {
+            log_w("write flash error, addr: 0x%08X", address + i);
+        }
+    }
+#endif
+    bl_flash_cache_resume();
+}
+
+void FLASH_IRQHandler(void)
+{
+    // 出错时不会置位EOP，OPERR保持置位会反复进中断，关闭ERRIE并保留标志给norflash_wait判断
+    if (FLASH->SR & FLASH_FLAG_OPERR)
+    {
+        FLASH_ITConfig(FLASH_IT_ERR, DISABLE);
+    }
+    FLASH->SR = FLASH_FLAG_EOP;
+    bl_event_set(BL_EVENT_FLASH);
+}
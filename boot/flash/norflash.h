@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 
+void bl_norflash_init(void);
 void bl_norflash_lock(void);
 void bl_norflash_unlock(void);
 void bl_norflash_erase(uint32_t address, uint32_t size);
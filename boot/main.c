@@ -3,6 +3,9 @@
 #include <stdio.h>
 #include "stm32f4xx.h"
 #include "main.h"
+#include "share.h"
+#include "clock.h"
+#include "norflash.h"
 
 
 
@@ -13,12 +16,15 @@
 
 int main(void)
 {
+    bl_share_timing_init();
+
     bl_lowlevel_init();
 
     bl_delay_init();
     bl_led_init(&led0);
     bl_button_init();
     bl_uart_init();
+    bl_norflash_init();
 
 #if DEBUG
     elog_init();
@@ -30,10 +36,19 @@ int main(void)
     elog_set_fmt(ELOG_LVL_VERBOSE, ELOG_FMT_TAG);
     elog_start();
 #endif
+    bl_share_stamp(BL_STAGE_INIT);
     
     bool trap_boot = false;
+    uint32_t baudrate, flags;
 
-    if (bl_button_pressed())
+    // APP请求的热进入：不校验固件、不等待，直接以请求的波特率进入命令模式
+    bool warm_entry = bl_share_request_take(&baudrate, &flags);
+    if (warm_entry)
+    {
+        trap_boot = true;
+        log_i("app request, trap into boot");
+    }
+    else if (bl_button_pressed())
     {
         trap_boot = true;
         log_i("button pressed, trap into boot");
@@ -44,11 +59,27 @@ int main(void)
         trap_boot = true;
     }
 
+    bl_share_stamp(BL_STAGE_VERIFY);
+
     if (trap_boot)
     {
         bl_led_on(&led0);
-        button_wait_release();
+        bl_clock_full();
+        if (warm_entry && baudrate && !bl_uart_set_baudrate(baudrate))
+        {
+            log_w("baudrate %u unsupported", baudrate);
+        }
+        if (!warm_entry)
+        {
+            button_wait_release();
+        }
+    }
+
+    // 监听窗口为0时不初始化接收流程，校验通过即引导
+    if (!trap_boot && BL_BOOT_LISTEN_MS == 0)
+    {
+        boot_application();
     }
 
-    bootloader_main(trap_boot ? 0 : 3);
+    bootloader_main(trap_boot ? 0 : BL_BOOT_LISTEN_MS, warm_entry && !(flags & BL_SHARE_FLAG_NO_READY));
 }
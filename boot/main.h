@@ -14,6 +14,17 @@ void bl_lowlevel_init(void);
 void bl_delay_init(void);
 void bl_delay_ms(uint32_t ms);
 uint32_t bl_now(void);
+uint32_t bl_cycles(void);
+
+// 栈使用统计，单位字节；peak等于painted时说明栈已越过填充区，实际峰值更大
+typedef struct
+{
+    uint32_t painted;                   // 复位时填充的栈顶区域大小
+    uint32_t peak;
+    uint32_t reserve;                   // 链接脚本中的_Min_Stack_Size
+} bl_stack_usage_t;
+
+void bl_stack_usage(bl_stack_usage_t *usage);
 
 
 #endif /* __MAIN_H */
\ No newline at end of file
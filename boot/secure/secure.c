@@ -0,0 +1,179 @@
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "main.h"
+#include "flash_layout.h"
+#include "secure.h"
+#include "p256.h"
+#include "aes.h"
+
+#define LOG_TAG     "secure"
+#define LOG_LVL     ELOG_LVL_INFO
+#include "elog.h"
+
+
+#define SIGNATURE_MAGIC     0x31474953      // "SIG1"
+#define FIRMWARE_KEY_BITS   128
+
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t algo;
+    uint8_t sig[P256_SIG_SIZE];
+} bl_signature_t;
+
+
+#if BL_SIGNED_BOOT
+#ifndef BL_SIGN_PUBKEY
+#error "BL_SIGNED_BOOT requires BL_SIGN_PUBKEY, build with CONFIG_SIGN_PUBKEY=<128 hex digits>"
+#endif
+
+// 验签公钥 x || y，由构建参数CONFIG_SIGN_PUBKEY给出
+static const uint8_t bl_sign_pubkey[] =
+{
+    BL_SIGN_PUBKEY
+};
+
+_Static_assert(sizeof(bl_sign_pubkey) == P256_KEY_SIZE, "BL_SIGN_PUBKEY must be 64 bytes");
+#endif
+
+#if BL_DECRYPT
+#ifndef BL_FW_KEY
+#error "BL_DECRYPT requires BL_FW_KEY, build with CONFIG_FW_KEY=<32 hex digits>"
+#endif
+
+// 固件解密密钥，由构建参数CONFIG_FW_KEY给出，需配合读保护使用
+static const uint8_t bl_firmware_key[] =
+{
+    BL_FW_KEY
+};
+
+_Static_assert(sizeof(bl_firmware_key) == FIRMWARE_KEY_BITS / 8, "BL_FW_KEY must be 16 bytes");
+
+static aes_ctx_t decrypt_ctx __attribute__((section(".ccmnoinit")));     // 由bl_secure_decrypt_start初始化
+static uint8_t decrypt_iv[SECURE_IV_SIZE];
+#endif
+static bool decrypt_enabled;
+
+
+/**
+ * @brief 用内置公钥校验签名尾部
+ * 
+ * @param digest 实际计算出的固件SHA-256
+ * @return true 签名有效
+ * @return false 签名缺失或无效，或构建时未开启BL_SIGNED_BOOT
+ */
+bool bl_secure_verify(const uint8_t digest[32])
+{
+#if BL_SIGNED_BOOT
+    const bl_signature_t *signature = (const bl_signature_t *)FLASH_SIGNATURE_ADDRESS;
+
+    if (signature->magic != SIGNATURE_MAGIC || signature->algo != SECURE_ALGO_ECDSA_P256)
+    {
+        log_w("signature missing");
+        return false;
+    }
+
+    uint32_t start = bl_cycles();
+    bool valid = p256_verify(bl_sign_pubkey, digest, signature->sig);
+    uint32_t cycles = bl_cycles() - start;
+
+    log_i("ecdsa-p256 verify %s, %u cycles", valid ? "pass" : "fail", cycles);
+    (void)cycles;
+
+    return valid;
+#else
+    (void)digest;
+    return false;
+#endif
+}
+
+/**
+ * @brief 开启加密传输，之后写入APP区的数据先解密再编程
+ * 
+ * @param iv 初始计数块
+ * @return true 
+ * @return false 构建时未开启BL_DECRYPT，或整个APP区的计数会使低32位回绕
+ */
+bool bl_secure_decrypt_start(const uint8_t iv[SECURE_IV_SIZE])
+{
+#if BL_DECRYPT
+    // 计数只在低32位内递增，回绕后与其他位置复用同一密钥流
+    uint32_t ctr = ((uint32_t)iv[12] << 24) | ((uint32_t)iv[13] << 16) | ((uint32_t)iv[14] << 8) | iv[15];
+    if (UINT32_MAX - ctr < FLASH_APP_SIZE / AES_BLOCK_SIZE - 1)
+    {
+        log_e("iv counter 0x%08X wraps", ctr);
+        return false;
+    }
+
+    aes_setkey(&decrypt_ctx, bl_firmware_key, FIRMWARE_KEY_BITS);
+    for (uint32_t i = 0; i < SECURE_IV_SIZE; i++)
+    {
+        decrypt_iv[i] = iv[i];
+    }
+    decrypt_enabled = true;
+    return true;
+#else
+    (void)iv;
+    return false;
+#endif
+}
+
+void bl_secure_decrypt_stop(void)
+{
+    decrypt_enabled = false;
+}
+
+bool bl_secure_decrypt_enabled(void)
+{
+    return decrypt_enabled;
+}
+
+/**
+ * @brief 原地解密一段写入APP区的数据
+ * 
+ * @param address 写入地址，相对APP区的偏移须按16字节对齐
+ * @param data 
+ * @param len 
+ * @return true 
+ * @return false 地址不在APP区或未对齐
+ */
+bool bl_secure_decrypt(uint32_t address, uint8_t *data, uint32_t len)
+{
+#if BL_DECRYPT
+    uint32_t offset = address - FLASH_APP_ADDRESS;
+
+    if (address < FLASH_APP_ADDRESS || offset >= FLASH_APP_SIZE || len > FLASH_APP_SIZE - offset ||
+        offset % AES_BLOCK_SIZE != 0)
+    {
+        log_e("decrypt 0x%08X invalid", address);
+        return false;
+    }
+
+    uint8_t counter[AES_BLOCK_SIZE];
+    for (uint32_t i = 0; i < AES_BLOCK_SIZE; i++)
+    {
+        counter[i] = decrypt_iv[i];
+    }
+    uint32_t ctr = ((uint32_t)counter[12] << 24) | ((uint32_t)counter[13] << 16) | ((uint32_t)counter[14] << 8) | counter[15];
+    ctr += offset / AES_BLOCK_SIZE;
+    counter[12] = ctr >> 24;
+    counter[13] = ctr >> 16;
+    counter[14] = ctr >> 8;
+    counter[15] = ctr;
+
+    uint32_t start = bl_cycles();
+    aes_ctr_xcrypt(&decrypt_ctx, counter, data, len);
+    uint32_t cycles = bl_cycles() - start;
+
+    log_i("aes-ctr: %u bytes, %u cycles", len, cycles);
+    (void)cycles;
+
+    return true;
+#else
+    (void)address;
+    (void)data;
+    (void)len;
+    return false;
+#endif
+}
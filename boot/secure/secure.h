@@ -0,0 +1,38 @@
+#ifndef __SECURE_H
+#define __SECURE_H
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* 签名尾部，由上位机写入FLASH_SIGNATURE_ADDRESS，紧邻arginfo记录
+ *
+ * | magic | algo | r     | s     |
+ * | u32   | u32  | u8*32 | u8*32 |
+ *
+ * 签名对象为固件的SHA-256摘要，algo目前只支持ECDSA-P256
+ *
+ * 验签约为256次倍点、256次点加和2次模逆，点加的特殊情况使耗时随签名略有变化；
+ * 只处理公开数据，不要求常数时间。运算次数上界与估算的最坏周期数(约8.6M，168MHz下约51ms)
+ * 见p256.c，实际周期数在每次验签后由DWT测得并打印
+ */
+
+#define SECURE_ALGO_ECDSA_P256      1
+
+/* 加密传输：上位机以AES-128-CTR加密APP区固件，计数块为IV，每16字节低32位大端加一，
+ * 写入地址相对FLASH_APP_ADDRESS的偏移决定该段数据的起始计数块，因此分包可乱序、可重传；
+ * 高96位作为nonce不参与递增，IV低32位加上APP区块数会回绕时拒绝开启；
+ * 构建时未开启BL_DECRYPT则不支持，上位机开启加密传输会收到BL_ERR_OPCODE
+ */
+#define SECURE_IV_SIZE              16
+
+
+bool bl_secure_verify(const uint8_t digest[32]);
+bool bl_secure_decrypt_start(const uint8_t iv[SECURE_IV_SIZE]);
+void bl_secure_decrypt_stop(void);
+bool bl_secure_decrypt_enabled(void);
+bool bl_secure_decrypt(uint32_t address, uint8_t *data, uint32_t len);
+
+
+#endif /* __SECURE_H */
\ No newline at end of file
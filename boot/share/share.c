@@ -0,0 +1,80 @@
+#include "stm32f4xx.h"
+#include "share.h"
+
+
+uint32_t bl_startup_cycles;                     // 由Reset_Handler在调用SystemInit前写入
+
+
+/**
+ * @brief 读取并清除APP留下的进入boot请求
+ * 
+ * @param baudrate 请求的波特率，0表示默认
+ * @param flags 请求的会话标志
+ * @return true APP请求停留在boot
+ * @return false 
+ */
+bool bl_share_request_take(uint32_t *baudrate, uint32_t *flags)
+{
+    bool request = BL_SHARE->request == BL_SHARE_REQUEST_BOOT;
+
+    *baudrate = request ? BL_SHARE->baudrate : 0;
+    *flags = request ? BL_SHARE->flags : 0;
+    BL_SHARE->request = 0;
+
+    return request;
+}
+
+/**
+ * @brief 初始化本次启动的阶段时间戳并作废旧的交接记录，须在main入口处调用
+ * 
+ */
+void bl_share_timing_init(void)
+{
+    volatile bl_timing_t *timing = &BL_SHARE->timing;
+
+    timing->magic = BL_TIMING_MAGIC;
+    timing->version = BL_TIMING_VERSION;
+    timing->count = BL_STAGE_MAX;
+    timing->pll_stamp = 0;
+    for (uint32_t i = 0; i < BL_STAGE_MAX; i++)
+    {
+        timing->stamp[i] = 0;
+    }
+    timing->stamp[BL_STAGE_STARTUP] = bl_startup_cycles;
+    timing->stamp[BL_STAGE_SYSINIT] = DWT->CYCCNT;
+
+    // 上一次启动遗留的交接记录作废
+    BL_SHARE->handoff.magic = 0;
+}
+
+/**
+ * @brief 记录某阶段结束时的周期数
+ * 
+ * @param stage 
+ */
+void bl_share_stamp(bl_stage_t stage)
+{
+    BL_SHARE->timing.stamp[stage] = DWT->CYCCNT;
+    BL_SHARE->timing.core_clock = SystemCoreClock;
+}
+
+/**
+ * @brief 记录跳转APP时的时钟配置，须在外设反初始化之后、跳转之前调用
+ * 
+ */
+void bl_share_handoff(void)
+{
+    volatile bl_handoff_t *handoff = &BL_SHARE->handoff;
+    RCC_ClocksTypeDef clocks;
+
+    RCC_GetClocksFreq(&clocks);
+
+    handoff->sysclk = clocks.SYSCLK_Frequency;
+    handoff->hclk = clocks.HCLK_Frequency;
+    handoff->pclk1 = clocks.PCLK1_Frequency;
+    handoff->pclk2 = clocks.PCLK2_Frequency;
+    handoff->rcc_cfgr = RCC->CFGR;
+    handoff->rcc_pllcfgr = RCC->PLLCFGR;
+    handoff->flash_acr = FLASH->ACR;
+    handoff->magic = BL_HANDOFF_MAGIC;
+}
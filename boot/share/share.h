@@ -0,0 +1,149 @@
+#ifndef __SHARE_H
+#define __SHARE_H
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* boot与APP共享的RAM区，位于RAM顶端，两边的链接脚本都不得占用，复位后内容保持
+ *
+ * APP须使用platform/stm32f407xx_app.ld（CONFIG_BOOTLOADER不为y时自动选用）或等效的链接脚本：
+ * RAM长度为128K - 256，_estack = 0x2001FF00，顶端256字节划为NOLOAD的BOOTSHARE区，
+ * 否则APP的栈从0x20020000向下生长，会覆盖请求字和本次启动的时间戳/交接记录
+ *
+ * 本头文件不依赖share.c，APP直接包含即可使用下方的内联读写函数
+ *
+ * APP请求进入boot升级模式：
+ *     bl_share_enter_boot(921600, 0);         // 0表示保持默认波特率
+ *     NVIC_SystemReset();
+ *
+ * boot收到请求后跳过固件校验和监听窗口，以请求的波特率进入命令模式，
+ * 并立即发送一帧BL_OP_READY，上位机收到后即可开始传输
+ *
+ * 上电时RAM内容随机，因此所有字段都以魔幻数判定有效性
+ */
+
+#define BL_SHARE_ADDRESS            0x2001FF00
+#define BL_SHARE_SIZE               256
+
+#define BL_SHARE_REQUEST_BOOT       0x544F4F42      // "BOOT"
+
+#define BL_SHARE_FLAG_NO_READY      (1ul << 0)      // 不发送BL_OP_READY
+
+#define BL_HANDOFF_MAGIC            0x46464F48      // "HOFF"
+
+#define BL_TIMING_MAGIC             0x454D4954      // "TIME"
+#define BL_TIMING_VERSION           2
+
+
+// boot各阶段结束时的DWT周期数，以复位为零点；切换到PLL之前按HSI 16MHz计数
+typedef enum
+{
+    BL_STAGE_STARTUP,                   // .data/.bss初始化
+    BL_STAGE_SYSINIT,                   // SystemInit时钟配置
+    BL_STAGE_INIT,                      // 外设及日志初始化
+    BL_STAGE_VERIFY,                    // 按键检测与固件校验
+    BL_STAGE_LISTEN,                    // 监听窗口或命令模式
+    BL_STAGE_DEINIT,                    // 外设反初始化，随后跳转APP
+    BL_STAGE_MAX
+} bl_stage_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;                     // stamp[]的有效项数
+    uint32_t core_clock;                // 跳转时的SystemCoreClock，用于换算时间
+    uint32_t pll_stamp;                 // 切换到PLL时的周期数，0表示SystemInit中已切换或始终未切换
+    uint32_t stamp[BL_STAGE_MAX];
+} bl_timing_t;
+
+/* boot跳转APP时的状态约定，magic有效即表示以下条件成立：
+ *
+ * 1、MSP为APP向量表首字，SCB->VTOR指向APP向量表，CONTROL为0（特权、MSP）
+ * 2、PRIMASK已清除，但所有NVIC中断已关闭且挂起位已清除，SysTick已关闭
+ * 3、时钟保持boot运行时的配置（PLL，或BL_CLOCK_LAZY_PLL下未切换时的HSI），
+ *    RCC->CFGR/PLLCFGR与FLASH->ACR为下表记录的值，
+ *    APP可比对后跳过SystemInit中的时钟配置，直接SystemCoreClockUpdate
+ * 4、boot用到的GPIOA/GPIOE/USART1/USART2/EXTI/SYSCFG已复位，其时钟与DMA2时钟已关闭
+ * 5、NVIC优先级分组为NVIC_PriorityGroup_4
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sysclk;                    // SYSCLK/HCLK/PCLK1/PCLK2频率，单位Hz
+    uint32_t hclk;
+    uint32_t pclk1;
+    uint32_t pclk2;
+    uint32_t rcc_cfgr;
+    uint32_t rcc_pllcfgr;
+    uint32_t flash_acr;
+} bl_handoff_t;
+
+typedef struct
+{
+    uint32_t request;                   // 进入boot请求，boot读取后清除
+    uint32_t baudrate;                  // 命令模式的波特率，仅request有效时有意义
+    uint32_t flags;                     // BL_SHARE_FLAG_*
+    uint32_t reserved;
+    bl_timing_t timing;                 // 本次启动的阶段时间戳，APP可读取上报
+    bl_handoff_t handoff;               // 跳转APP时的系统状态
+} bl_share_t;
+
+#define BL_SHARE                    ((volatile bl_share_t *)BL_SHARE_ADDRESS)
+
+_Static_assert(sizeof(bl_share_t) <= BL_SHARE_SIZE, "bl_share_t exceeds the share area");
+
+
+/**
+ * @brief APP写入进入boot请求，随后由APP自行复位
+ * 
+ * @param baudrate 命令模式的波特率，0表示默认
+ * @param flags BL_SHARE_FLAG_*
+ */
+static inline void bl_share_enter_boot(uint32_t baudrate, uint32_t flags)
+{
+    BL_SHARE->baudrate = baudrate;
+    BL_SHARE->flags = flags;
+    BL_SHARE->request = BL_SHARE_REQUEST_BOOT;
+}
+
+/**
+ * @brief APP读取本次启动的阶段时间戳
+ * 
+ * @return 记录无效或版本不符时返回NULL
+ */
+static inline const volatile bl_timing_t *bl_share_timing(void)
+{
+    const volatile bl_timing_t *timing = &BL_SHARE->timing;
+
+    if (timing->magic != BL_TIMING_MAGIC || timing->version != BL_TIMING_VERSION)
+    {
+        return NULL;
+    }
+
+    return timing;
+}
+
+/**
+ * @brief APP读取boot跳转时的系统状态
+ * 
+ * @return 未经boot跳转（如调试器直接启动APP）时返回NULL
+ */
+static inline const volatile bl_handoff_t *bl_share_handoff_get(void)
+{
+    const volatile bl_handoff_t *handoff = &BL_SHARE->handoff;
+
+    return handoff->magic == BL_HANDOFF_MAGIC ? handoff : NULL;
+}
+
+
+bool bl_share_request_take(uint32_t *baudrate, uint32_t *flags);
+void bl_share_timing_init(void);
+void bl_share_stamp(bl_stage_t stage);
+void bl_share_handoff(void);
+
+
+#endif /* __SHARE_H */
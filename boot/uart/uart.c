@@ -1,8 +1,18 @@
 #include "stm32f4xx.h"
 #include "uart.h"
+#include "event.h"
+#include "ringbuffer8.h"
+
+
+#define UART_BAUDRATE_DEFAULT   115200
+#define UART_BAUDRATE_MIN       1200
+#define UART_TX_BUFFER_SIZE     256
 
 
 static bl_uart_recv_cb_t bl_uart_recv_cb;
+static uint32_t uart_baudrate;
+static ringbuffer8_t uart_tx_rb;                                // 发送队列，由TXE中断取出
+static uint8_t uart_tx_buffer[RB8_BUFFER_SIZE(UART_TX_BUFFER_SIZE)] __attribute__((aligned(4), section(".ccmnoinit")));
 
 
 static void uart_io_init(void)
@@ -29,16 +39,17 @@ static void uart_nvic_init(void)
     NVIC_Init(&NVIC_InitStructure);
 }
 
-static void uart_lowlevel_init(void)
+static void uart_lowlevel_init(uint32_t baudrate)
 {
     USART_InitTypeDef USART_InitStructure;
-    USART_InitStructure.USART_BaudRate = 115200;
+    USART_InitStructure.USART_BaudRate = baudrate;
     USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
     USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
     USART_InitStructure.USART_Parity = USART_Parity_No;
     USART_InitStructure.USART_StopBits = USART_StopBits_1;
     USART_InitStructure.USART_WordLength = USART_WordLength_8b;
     USART_Init(USART2, &USART_InitStructure);
+    uart_baudrate = baudrate;
 
     USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
     USART_Cmd(USART2, ENABLE);
@@ -46,22 +57,85 @@ static void uart_lowlevel_init(void)
 
 void bl_uart_init(void)
 {
+    uart_tx_rb = rb8_new(uart_tx_buffer, sizeof(uart_tx_buffer));
+
     uart_io_init();
     uart_nvic_init();
-    uart_lowlevel_init();
+    uart_lowlevel_init(UART_BAUDRATE_DEFAULT);
 }
 
-void bl_uart_write(uint8_t *data, uint16_t len)
+/**
+ * @brief 切换波特率，等待当前发送完成后重新配置USART
+ * 
+ * @param baudrate 
+ * @return true 
+ * @return false 超出USART2可分频的范围，保持原波特率
+ */
+bool bl_uart_set_baudrate(uint32_t baudrate)
 {
-    // 确保这一帧数据发送前,TC标志是未置位的，以及确保正确等待当前数据的完整发送
-    USART_ClearFlag(USART2, USART_FLAG_TC);
+    RCC_ClocksTypeDef clocks;
 
-    for (uint16_t i = 0; i < len; i ++)
+    RCC_GetClocksFreq(&clocks);
+    if (baudrate < UART_BAUDRATE_MIN || baudrate > clocks.PCLK1_Frequency / 16)
     {
-        while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) != SET);
-        USART_SendData(USART2, data[i]);
+        return false;
     }
 
+    bl_uart_flush();
+    USART_Cmd(USART2, DISABLE);
+    uart_lowlevel_init(baudrate);
+
+    return true;
+}
+
+uint32_t bl_uart_baudrate(void)
+{
+    return uart_baudrate;
+}
+
+/**
+ * @brief 数据放入发送队列后立即返回，由中断发送；队列满时等待中断腾出空间
+ * 
+ * @param data 
+ * @param len 
+ */
+void bl_uart_write(uint8_t *data, uint16_t len)
+{
+    while (len)
+    {
+        // 只写入已腾出的空间，队列满时的等待不计入溢出统计
+        uint32_t n = rb8_free(uart_tx_rb);
+        if (n > len) n = len;
+
+        if (n)
+        {
+            rb8_puts(uart_tx_rb, data, n);
+            data += n;
+            len -= n;
+        }
+
+        USART_ITConfig(USART2, USART_IT_TXE, ENABLE);
+    }
+}
+
+/**
+ * @brief 发送队列，供查询统计
+ * 
+ * @return ringbuffer8_t 
+ */
+ringbuffer8_t bl_uart_tx_ring(void)
+{
+    return uart_tx_rb;
+}
+
+/**
+ * @brief 等待发送队列清空且最后一字节移出移位寄存器，切换波特率、复位或跳转前调用
+ * 
+ */
+void bl_uart_flush(void)
+{
+    while (!rb8_empty(uart_tx_rb) || (USART2->CR1 & USART_CR1_TXEIE));
+
     // TC=1，之后才可禁止 USART 或使微控制器进入低功率模式
     while (USART_GetFlagStatus(USART2, USART_FLAG_TC) != SET);
 }
@@ -81,4 +155,25 @@ void USART2_IRQHandler(void)
             bl_uart_recv_cb(&data, 1);
         }
     }
+
+    if (USART_GetITStatus(USART2, USART_IT_TXE) != RESET)
+    {
+        uint8_t data;
+        if (rb8_get(uart_tx_rb, &data))
+        {
+            USART_SendData(USART2, data);
+        }
+        else
+        {
+            // 队列已空，等最后一字节发完再通知
+            USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
+            USART_ITConfig(USART2, USART_IT_TC, ENABLE);
+        }
+    }
+
+    if (USART_GetITStatus(USART2, USART_IT_TC) != RESET)
+    {
+        USART_ITConfig(USART2, USART_IT_TC, DISABLE);
+        bl_event_set(BL_EVENT_TX);
+    }
 }
\ No newline at end of file
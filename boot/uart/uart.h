@@ -3,13 +3,19 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "ringbuffer8.h"
 
 
 typedef void (*bl_uart_recv_cb_t)(uint8_t *data, uint32_t len);
 
 
 void bl_uart_init(void);
+bool bl_uart_set_baudrate(uint32_t baudrate);
+uint32_t bl_uart_baudrate(void);
 void bl_uart_write(uint8_t *data, uint16_t len);
+void bl_uart_flush(void);
+ringbuffer8_t bl_uart_tx_ring(void);
 void bl_uart_recv_cb_register(bl_uart_recv_cb_t callback);
 
 
@@ -1,8 +1,10 @@
 #include "stm32f4xx.h"
+#include "clock.h"
 
 void bl_lowlevel_init(void)
 {
     SystemCoreClockUpdate();
+    bl_flash_profile_apply(BL_FLASH_PROFILE_FULL);
 
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
 
@@ -1,6 +1,17 @@
 #include <stdint.h>
 #include "stm32f4xx.h"
 #include "system_stm32f4xx.h"
+#include "event.h"
+#include "button.h"
+#include "main.h"
+
+
+#define BL_STACK_PAINT      0xA5A5A5A5ul    // 与startup中的填充值一致
+
+// 链接脚本符号
+extern uint32_t _sstack_paint[];
+extern uint32_t _estack[];
+extern uint32_t _Min_Stack_Size[];
 
 
 static uint32_t ticks;
@@ -35,6 +46,34 @@ uint32_t bl_now(void)
     return ticks;
 }
 
+/**
+ * @brief 返回DWT周期计数，计数器在Reset_Handler中开启
+ * 
+ */
+uint32_t bl_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief 统计栈使用峰值，从填充区底部向上找到第一个被改写的字
+ * 
+ * @param usage 
+ */
+void bl_stack_usage(bl_stack_usage_t *usage)
+{
+    uint32_t *p = _sstack_paint;
+
+    while (p < _estack && *p == BL_STACK_PAINT)
+    {
+        p++;
+    }
+
+    usage->painted = (uint32_t)(_estack - _sstack_paint) * 4;
+    usage->peak = (uint32_t)(_estack - p) * 4;
+    usage->reserve = (uint32_t)_Min_Stack_Size;
+}
+
 /**
  * @brief 一毫秒产生一次中断
  * 
@@ -42,4 +81,6 @@ uint32_t bl_now(void)
 void SysTick_Handler(void)
 {
     ticks ++;
+    bl_event_set(BL_EVENT_TICK);
+    bl_button_tick();
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef __AES_H
+#define __AES_H
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#define AES_BLOCK_SIZE          16
+#define AES_KEY_SIZE_MAX        32
+
+
+typedef struct
+{
+    uint32_t rk[60];                    // 轮密钥，小端字
+    uint32_t rounds;
+#if AES_USE_CRYP
+    uint32_t key_bits;
+    uint8_t key[AES_KEY_SIZE_MAX];
+#endif
+} aes_ctx_t;
+
+
+void aes_setkey(aes_ctx_t *ctx, const uint8_t *key, uint32_t key_bits);
+void aes_encrypt_block(const aes_ctx_t *ctx, const uint8_t in[AES_BLOCK_SIZE], uint8_t out[AES_BLOCK_SIZE]);
+/*
+ * CTR计数块为 96位nonce || 32位大端块计数，每块只有低32位加一，回绕时不向nonce进位，
+ * 与CRYP外设的计数方式一致；调用者须保证一次加密的块数不会使低32位回绕
+ */
+void aes_ctr_xcrypt(const aes_ctx_t *ctx, const uint8_t counter[AES_BLOCK_SIZE], uint8_t *data, uint32_t len);
+
+#if AES_USE_CRYP
+bool aes_ctr_hw(const aes_ctx_t *ctx, const uint8_t counter[AES_BLOCK_SIZE], uint8_t *data, uint32_t len);
+#endif
+
+
+#endif /* __AES_H */
@@ -0,0 +1,158 @@
+#include "aes.h"
+
+#if AES_USE_CRYP
+
+// 标准库的器件宏按系列划分，F405/407与F415/417同为STM32F40_41xxx，开启AES_USE_CRYP即表示器件带CRYP
+#if !defined(STM32F40_41xxx) && !defined(STM32F427_437xx) && !defined(STM32F429_439xx)
+#error "CRYP peripheral exists only on STM32F415/417/437/439"
+#endif
+
+#include "stm32f4xx.h"
+
+
+#define CRYP_DMA_IN_STREAM      DMA2_Stream6
+#define CRYP_DMA_OUT_STREAM     DMA2_Stream5
+#define CRYP_DMA_CHANNEL        DMA_Channel_2
+#define CRYP_DMA_IN_FLAG_TC     DMA_FLAG_TCIF6
+#define CRYP_DMA_OUT_FLAG_TC    DMA_FLAG_TCIF5
+
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void cryp_dma_config(DMA_Stream_TypeDef *stream, uint32_t dir, uint32_t periph, uint32_t memory,
+                            uint32_t words)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(stream);
+    DMA_InitStructure.DMA_Channel = CRYP_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = periph;
+    DMA_InitStructure.DMA_Memory0BaseAddr = memory;
+    DMA_InitStructure.DMA_DIR = dir;
+    DMA_InitStructure.DMA_BufferSize = words;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Enable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_INC4;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_INC4;
+    DMA_Init(stream, &DMA_InitStructure);
+}
+
+/**
+ * @brief 使用CRYP外设的AES-CTR原地加解密，整块部分由DMA搬运，末尾不足16字节的部分由CPU补齐处理
+ * 
+ * @param ctx 
+ * @param counter 
+ * @param data 
+ * @param len 
+ * @return true 已由硬件完成
+ * @return false data未按字对齐或位于DMA不可访问的CCM，需由软件处理
+ */
+bool aes_ctr_hw(const aes_ctx_t *ctx, const uint8_t counter[AES_BLOCK_SIZE], uint8_t *data, uint32_t len)
+{
+    CRYP_InitTypeDef CRYP_InitStructure;
+    CRYP_KeyInitTypeDef CRYP_KeyInitStructure;
+    CRYP_IVInitTypeDef CRYP_IVInitStructure;
+    uint32_t key[8];
+
+    // DMA按字搬运，且DMA不能访问CCM(0x10000000)
+    if (((uint32_t)data & 3) || ((uint32_t)data & 0xFF000000) == 0x10000000)
+    {
+        return false;
+    }
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_CRYP, ENABLE);
+
+    // 密钥右对齐到Key3Right
+    uint32_t nk = ctx->key_bits / 32;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        key[i] = i < 8 - nk ? 0 : load_be32(ctx->key + (i - (8 - nk)) * 4);
+    }
+    CRYP_KeyInitStructure.CRYP_Key0Left = key[0];
+    CRYP_KeyInitStructure.CRYP_Key0Right = key[1];
+    CRYP_KeyInitStructure.CRYP_Key1Left = key[2];
+    CRYP_KeyInitStructure.CRYP_Key1Right = key[3];
+    CRYP_KeyInitStructure.CRYP_Key2Left = key[4];
+    CRYP_KeyInitStructure.CRYP_Key2Right = key[5];
+    CRYP_KeyInitStructure.CRYP_Key3Left = key[6];
+    CRYP_KeyInitStructure.CRYP_Key3Right = key[7];
+
+    CRYP_IVInitStructure.CRYP_IV0Left = load_be32(counter + 0);
+    CRYP_IVInitStructure.CRYP_IV0Right = load_be32(counter + 4);
+    CRYP_IVInitStructure.CRYP_IV1Left = load_be32(counter + 8);
+    CRYP_IVInitStructure.CRYP_IV1Right = load_be32(counter + 12);
+
+    CRYP_InitStructure.CRYP_AlgoDir = CRYP_AlgoDir_Decrypt;
+    CRYP_InitStructure.CRYP_AlgoMode = CRYP_AlgoMode_AES_CTR;
+    CRYP_InitStructure.CRYP_DataType = CRYP_DataType_8b;
+    CRYP_InitStructure.CRYP_KeySize = ctx->key_bits == 128 ? CRYP_KeySize_128b :
+                                      ctx->key_bits == 192 ? CRYP_KeySize_192b : CRYP_KeySize_256b;
+
+    CRYP_DeInit();
+    CRYP_KeyInit(&CRYP_KeyInitStructure);
+    CRYP_Init(&CRYP_InitStructure);
+    CRYP_IVInit(&CRYP_IVInitStructure);
+    CRYP_FIFOFlush();
+    CRYP_Cmd(ENABLE);
+
+    uint32_t words = (len / AES_BLOCK_SIZE) * (AES_BLOCK_SIZE / 4);
+    if (words)
+    {
+        // 输出流先于输入流使能，原地处理时OUT始终落后于IN
+        cryp_dma_config(CRYP_DMA_OUT_STREAM, DMA_DIR_PeripheralToMemory, (uint32_t)&CRYP->DOUT,
+                        (uint32_t)data, words);
+        cryp_dma_config(CRYP_DMA_IN_STREAM, DMA_DIR_MemoryToPeripheral, (uint32_t)&CRYP->DR,
+                        (uint32_t)data, words);
+        CRYP_DMACmd(CRYP_DMAReq_DataIN | CRYP_DMAReq_DataOUT, ENABLE);
+        DMA_Cmd(CRYP_DMA_OUT_STREAM, ENABLE);
+        DMA_Cmd(CRYP_DMA_IN_STREAM, ENABLE);
+
+        while (DMA_GetFlagStatus(CRYP_DMA_OUT_STREAM, CRYP_DMA_OUT_FLAG_TC) == RESET);
+        DMA_ClearFlag(CRYP_DMA_IN_STREAM, CRYP_DMA_IN_FLAG_TC);
+        DMA_ClearFlag(CRYP_DMA_OUT_STREAM, CRYP_DMA_OUT_FLAG_TC);
+        CRYP_DMACmd(CRYP_DMAReq_DataIN | CRYP_DMAReq_DataOUT, DISABLE);
+    }
+
+    uint32_t tail = len % AES_BLOCK_SIZE;
+    if (tail)
+    {
+        uint32_t block[AES_BLOCK_SIZE / 4] = { 0 };
+        uint8_t *bytes = (uint8_t *)block;
+        uint8_t *p = data + len - tail;
+
+        for (uint32_t i = 0; i < tail; i++)
+        {
+            bytes[i] = p[i];
+        }
+        for (uint32_t i = 0; i < AES_BLOCK_SIZE / 4; i++)
+        {
+            CRYP_DataIn(block[i]);
+        }
+        while (CRYP_GetFlagStatus(CRYP_FLAG_OFNE) == RESET);
+        for (uint32_t i = 0; i < AES_BLOCK_SIZE / 4; i++)
+        {
+            block[i] = CRYP_DataOut();
+        }
+        for (uint32_t i = 0; i < tail; i++)
+        {
+            p[i] = bytes[i];
+        }
+    }
+
+    CRYP_Cmd(DISABLE);
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_CRYP, DISABLE);
+
+    return true;
+}
+
+#endif /* AES_USE_CRYP */
@@ -2,10 +2,24 @@
 
 
 #define CRC32_TABLE_SIZE    0x100
+#define CRC32_POLY          0xedb88320
 
 
 static uint8_t inited = 0;
-static uint32_t crc32_table[CRC32_TABLE_SIZE];
+static uint32_t crc32_table[CRC32_TABLE_SIZE] __attribute__((section(".ccmnoinit")));   // 由crc32_init填充
+
+// x^(2^n) mod P，n = 0..31，用于把"追加len个零字节"的运算化为至多32次GF(2)乘法
+static const uint32_t crc32_x2n_table[32] =
+{
+    0x40000000, 0x20000000, 0x08000000, 0x00800000,
+    0x00008000, 0xedb88320, 0xb1e6b092, 0xa06a2517,
+    0xed627dae, 0x88d14467, 0xd7bbfe6a, 0xec447f11,
+    0x8e7ea170, 0x6427800e, 0x4d47bae0, 0x09fe548f,
+    0x83852d0f, 0x30362f1a, 0x7b5a9cc3, 0x31fec169,
+    0x9fec022a, 0x6c8dedc4, 0x15d6874d, 0x5fde7a4e,
+    0xbad90e37, 0x2e4e5eef, 0x4eaba214, 0xa8a472c0,
+    0x429a969e, 0x148d302a, 0xc40ba6d0, 0xc4e22c3c,
+};
 
 
 static uint32_t crc32_for_byte(uint32_t r)
@@ -42,3 +56,50 @@ uint32_t crc32_update(uint32_t crc, uint8_t *data, uint32_t len)
 
     return crc;
 }
+
+/* GF(2)多项式乘法 a * b mod P，比特反序表示 */
+static uint32_t crc32_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = (uint32_t)1 << 31;
+    uint32_t p = 0;
+
+    for (;;)
+    {
+        if (a & m)
+        {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+            {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC32_POLY : b >> 1;
+    }
+
+    return p;
+}
+
+/* x^(len * 8) mod P */
+static uint32_t crc32_x8nmodp(uint32_t len)
+{
+    uint32_t p = (uint32_t)1 << 31;
+    uint32_t k = 3;
+
+    while (len)
+    {
+        if (len & 1)
+        {
+            p = crc32_multmodp(crc32_x2n_table[k & 31], p);
+        }
+        len >>= 1;
+        k++;
+    }
+
+    return p;
+}
+
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint32_t len_b)
+{
+    return crc32_multmodp(crc32_x8nmodp(len_b), crc_a) ^ crc_b;
+}
@@ -7,6 +7,7 @@
 
 void     crc32_init(void);
 uint32_t crc32_update(uint32_t crc, uint8_t *data, uint32_t len);
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint32_t len_b);
 
 
 #endif /*__CRC32_H */
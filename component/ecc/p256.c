@@ -0,0 +1,502 @@
+#include "p256.h"
+
+
+/*
+ * ECDSA-P256签名验证
+ *
+ * 域元素与标量均为8个32位小端limb，运算在Montgomery域内进行。
+ * Montgomery乘法为CIOS形式，内层 (u64)a*b + t + c 恰好对应Cortex-M4的UMAAL；
+ * 加减与约简均用掩码选择。
+ * 标量乘为Shamir双标量梯形，每一位做一次倍点和一次点加；点加对无穷远点和相同点有提前返回，
+ * 因此耗时随u1、u2和中间结果变化，不是常数时间。
+ * 验签的输入(公钥、摘要、签名)都是公开数据，不需要常数时间；不可用于处理私钥的签名运算。
+ *
+ * 耗时上界：按代码路径逐项累加，单次验签最多6980次Montgomery乘法、8729次模加减，
+ * 与签名内容无关；test/test_p256.c统计实际次数并检查不超过该上界(测试向量最大为6964/7429)。
+ * 按Cortex-M4每次乘法约1050周期(128次乘累加，每次约7周期加首尾开销)、每次加减约150周期估算，
+ * 最坏约8.6M周期，168MHz下约51ms。周期系数为估算值，未在硬件上测量，
+ * 实际值以bl_secure_verify每次验签后DWT测得并打印的周期数为准。
+ */
+
+#define P256_LIMBS      8
+
+// 主机端测试统计域运算次数，用于给出验签耗时上界；固件中为空
+#ifdef P256_COUNT_OPS
+extern uint32_t p256_count_mul, p256_count_add;
+#define P256_COUNT(op)  (p256_count_##op++)
+#else
+#define P256_COUNT(op)
+#endif
+
+typedef struct
+{
+    uint32_t m[P256_LIMBS];
+    uint32_t mprime;                // -m^-1 mod 2^32
+    uint32_t rr[P256_LIMBS];        // R^2 mod m
+    uint32_t one[P256_LIMBS];       // R mod m
+} p256_mod_t;
+
+typedef struct
+{
+    uint32_t x[P256_LIMBS];
+    uint32_t y[P256_LIMBS];
+    uint32_t z[P256_LIMBS];
+} p256_point_t;
+
+
+static const p256_mod_t mod_p =
+{
+    .m      = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xffffffff },
+    .mprime = 0x00000001,
+    .rr     = { 0x00000003, 0x00000000, 0xffffffff, 0xfffffffb, 0xfffffffe, 0xffffffff, 0xfffffffd, 0x00000004 },
+    .one    = { 0x00000001, 0x00000000, 0x00000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xfffffffe, 0x00000000 },
+};
+
+static const p256_mod_t mod_n =
+{
+    .m      = { 0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff },
+    .mprime = 0xee00bc4f,
+    .rr     = { 0xbe79eea2, 0x83244c95, 0x49bd6fa6, 0x4699799c, 0x2b6bec59, 0x2845b239, 0xf3d95620, 0x66e12d94 },
+    .one    = { 0x039cdaaf, 0x0c46353d, 0x58e8617b, 0x43190552, 0x00000000, 0x00000000, 0xffffffff, 0x00000000 },
+};
+
+// 曲线参数b与基点G，均已转换到Montgomery域
+static const uint32_t curve_b[P256_LIMBS] =
+{
+    0x29c4bddf, 0xd89cdf62, 0x78843090, 0xacf005cd, 0xf7212ed6, 0xe5a220ab, 0x04874834, 0xdc30061d
+};
+
+static const p256_point_t curve_g =
+{
+    .x = { 0x18a9143c, 0x79e730d4, 0x5fedb601, 0x75ba95fc, 0x77622510, 0x79fb732b, 0xa53755c6, 0x18905f76 },
+    .y = { 0xce95560a, 0xddf25357, 0xba19e45c, 0x8b4ab8e4, 0xdd21f325, 0xd2e88688, 0x25885d85, 0x8571ff18 },
+    .z = { 0x00000001, 0x00000000, 0x00000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xfffffffe, 0x00000000 },
+};
+
+
+static void int_copy(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS])
+{
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        r[i] = a[i];
+    }
+}
+
+static bool int_is_zero(const uint32_t a[P256_LIMBS])
+{
+    uint32_t acc = 0;
+
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc |= a[i];
+    }
+
+    return acc == 0;
+}
+
+/* a < b，仅用于公开数据的范围检查 */
+static bool int_less(const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+    for (int32_t i = P256_LIMBS - 1; i >= 0; i--)
+    {
+        if (a[i] != b[i])
+        {
+            return a[i] < b[i];
+        }
+    }
+
+    return false;
+}
+
+static void int_from_bytes(uint32_t r[P256_LIMBS], const uint8_t *be)
+{
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        const uint8_t *p = be + (P256_LIMBS - 1 - i) * 4;
+        r[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+}
+
+/* 按掩码选择：mask全1取a，全0取b */
+static void int_select(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS],
+                       uint32_t mask)
+{
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        r[i] = (a[i] & mask) | (b[i] & ~mask);
+    }
+}
+
+/* r = a * b * R^-1 mod m，CIOS */
+static void mont_mul(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS],
+                     const p256_mod_t *mod)
+{
+    uint32_t t[P256_LIMBS + 2];
+    uint32_t d[P256_LIMBS];
+    uint32_t carry;
+    uint64_t acc;
+
+    P256_COUNT(mul);
+    for (uint32_t i = 0; i < P256_LIMBS + 2; i++)
+    {
+        t[i] = 0;
+    }
+
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        carry = 0;
+        for (uint32_t j = 0; j < P256_LIMBS; j++)
+        {
+            acc = (uint64_t)a[j] * b[i] + t[j] + carry;
+            t[j] = (uint32_t)acc;
+            carry = acc >> 32;
+        }
+        acc = (uint64_t)t[P256_LIMBS] + carry;
+        t[P256_LIMBS] = (uint32_t)acc;
+        t[P256_LIMBS + 1] = acc >> 32;
+
+        uint32_t q = t[0] * mod->mprime;
+        acc = (uint64_t)q * mod->m[0] + t[0];
+        carry = acc >> 32;
+        for (uint32_t j = 1; j < P256_LIMBS; j++)
+        {
+            acc = (uint64_t)q * mod->m[j] + t[j] + carry;
+            t[j - 1] = (uint32_t)acc;
+            carry = acc >> 32;
+        }
+        acc = (uint64_t)t[P256_LIMBS] + carry;
+        t[P256_LIMBS - 1] = (uint32_t)acc;
+        t[P256_LIMBS] = t[P256_LIMBS + 1] + (uint32_t)(acc >> 32);
+    }
+
+    // t < 2m，无条件计算 t - m，再按进位/借位选择结果
+    uint32_t borrow = 0;
+    for (uint32_t j = 0; j < P256_LIMBS; j++)
+    {
+        acc = (uint64_t)t[j] - mod->m[j] - borrow;
+        d[j] = (uint32_t)acc;
+        borrow = (uint32_t)(acc >> 32) & 1;
+    }
+
+    int_select(r, d, t, -(t[P256_LIMBS] | (borrow ^ 1)));
+}
+
+static void mod_add(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS],
+                    const p256_mod_t *mod)
+{
+    uint32_t s[P256_LIMBS], d[P256_LIMBS];
+    uint32_t carry = 0, borrow = 0;
+    uint64_t acc;
+
+    P256_COUNT(add);
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc = (uint64_t)a[i] + b[i] + carry;
+        s[i] = (uint32_t)acc;
+        carry = acc >> 32;
+    }
+
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc = (uint64_t)s[i] - mod->m[i] - borrow;
+        d[i] = (uint32_t)acc;
+        borrow = (uint32_t)(acc >> 32) & 1;
+    }
+
+    int_select(r, d, s, -(carry | (borrow ^ 1)));
+}
+
+static void mod_sub(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS],
+                    const p256_mod_t *mod)
+{
+    uint32_t d[P256_LIMBS];
+    uint32_t carry = 0, borrow = 0;
+    uint64_t acc;
+
+    P256_COUNT(add);
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc = (uint64_t)a[i] - b[i] - borrow;
+        d[i] = (uint32_t)acc;
+        borrow = (uint32_t)(acc >> 32) & 1;
+    }
+
+    // 有借位时加回m
+    uint32_t mask = -borrow;
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc = (uint64_t)d[i] + (mod->m[i] & mask) + carry;
+        r[i] = (uint32_t)acc;
+        carry = acc >> 32;
+    }
+}
+
+/* r = a^(m-2)，Montgomery域内求逆；指数是公开常量，按位分支不泄露数据 */
+static void mod_inv(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const p256_mod_t *mod)
+{
+    uint32_t e[P256_LIMBS], x[P256_LIMBS];
+
+    int_copy(e, mod->m);
+    e[0] -= 2;
+    int_copy(x, mod->one);
+
+    for (int32_t i = 255; i >= 0; i--)
+    {
+        mont_mul(x, x, x, mod);
+        if ((e[i / 32] >> (i % 32)) & 1)
+        {
+            mont_mul(x, x, a, mod);
+        }
+    }
+
+    int_copy(r, x);
+}
+
+#define fp_mul(r, a, b)     mont_mul(r, a, b, &mod_p)
+#define fp_add(r, a, b)     mod_add(r, a, b, &mod_p)
+#define fp_sub(r, a, b)     mod_sub(r, a, b, &mod_p)
+
+/* Jacobian倍点，a = -3 (dbl-2001-b)，r可与p相同 */
+static void point_double(p256_point_t *r, const p256_point_t *p)
+{
+    uint32_t delta[P256_LIMBS], gamma[P256_LIMBS], beta[P256_LIMBS], alpha[P256_LIMBS];
+    uint32_t t1[P256_LIMBS], t2[P256_LIMBS];
+
+    fp_mul(delta, p->z, p->z);
+    fp_mul(gamma, p->y, p->y);
+    fp_mul(beta, p->x, gamma);
+
+    // alpha = 3 * (x - delta) * (x + delta)
+    fp_sub(t1, p->x, delta);
+    fp_add(t2, p->x, delta);
+    fp_mul(alpha, t1, t2);
+    fp_add(t1, alpha, alpha);
+    fp_add(alpha, alpha, t1);
+
+    // z3 = (y + z)^2 - gamma - delta
+    fp_add(t1, p->y, p->z);
+    fp_mul(t1, t1, t1);
+    fp_sub(t1, t1, gamma);
+    fp_sub(r->z, t1, delta);
+
+    // x3 = alpha^2 - 8 * beta
+    fp_add(beta, beta, beta);
+    fp_add(beta, beta, beta);
+    fp_mul(t1, alpha, alpha);
+    fp_sub(t1, t1, beta);
+    fp_sub(r->x, t1, beta);
+
+    // y3 = alpha * (4 * beta - x3) - 8 * gamma^2
+    fp_sub(t1, beta, r->x);
+    fp_mul(t1, alpha, t1);
+    fp_mul(gamma, gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_sub(r->y, t1, gamma);
+}
+
+/* Jacobian点加 (add-2007-bl)，z为0表示无穷远点，r可与p、q相同 */
+static void point_add(p256_point_t *r, const p256_point_t *p, const p256_point_t *q)
+{
+    uint32_t z1z1[P256_LIMBS], z2z2[P256_LIMBS], u1[P256_LIMBS], u2[P256_LIMBS];
+    uint32_t s1[P256_LIMBS], s2[P256_LIMBS], h[P256_LIMBS], rr[P256_LIMBS];
+    uint32_t i[P256_LIMBS], j[P256_LIMBS], v[P256_LIMBS];
+    p256_point_t t;
+
+    if (int_is_zero(p->z))
+    {
+        *r = *q;
+        return;
+    }
+
+    if (int_is_zero(q->z))
+    {
+        *r = *p;
+        return;
+    }
+
+    fp_mul(z1z1, p->z, p->z);
+    fp_mul(z2z2, q->z, q->z);
+    fp_mul(u1, p->x, z2z2);
+    fp_mul(u2, q->x, z1z1);
+    fp_mul(s1, p->y, q->z);
+    fp_mul(s1, s1, z2z2);
+    fp_mul(s2, q->y, p->z);
+    fp_mul(s2, s2, z1z1);
+    fp_sub(h, u2, u1);
+    fp_sub(rr, s2, s1);
+
+    if (int_is_zero(h))
+    {
+        if (int_is_zero(rr))
+        {
+            point_double(r, p);
+        }
+        else
+        {
+            // P = -Q，结果为无穷远点
+            for (uint32_t k = 0; k < P256_LIMBS; k++)
+            {
+                r->z[k] = 0;
+            }
+        }
+        return;
+    }
+
+    fp_add(rr, rr, rr);
+    fp_add(i, h, h);
+    fp_mul(i, i, i);
+    fp_mul(j, h, i);
+    fp_mul(v, u1, i);
+
+    // x3 = rr^2 - j - 2 * v
+    fp_mul(t.x, rr, rr);
+    fp_sub(t.x, t.x, j);
+    fp_sub(t.x, t.x, v);
+    fp_sub(t.x, t.x, v);
+
+    // y3 = rr * (v - x3) - 2 * s1 * j
+    fp_sub(t.y, v, t.x);
+    fp_mul(t.y, rr, t.y);
+    fp_mul(s1, s1, j);
+    fp_add(s1, s1, s1);
+    fp_sub(t.y, t.y, s1);
+
+    // z3 = ((z1 + z2)^2 - z1z1 - z2z2) * h
+    fp_add(t.z, p->z, q->z);
+    fp_mul(t.z, t.z, t.z);
+    fp_sub(t.z, t.z, z1z1);
+    fp_sub(t.z, t.z, z2z2);
+    fp_mul(t.z, t.z, h);
+
+    *r = t;
+}
+
+static void point_select(p256_point_t *r, const p256_point_t *a, uint32_t mask)
+{
+    int_select(r->x, a->x, r->x, mask);
+    int_select(r->y, a->y, r->y, mask);
+    int_select(r->z, a->z, r->z, mask);
+}
+
+/* 公钥须在曲线上：y^2 = x^3 - 3x + b */
+static bool point_on_curve(const p256_point_t *p)
+{
+    uint32_t lhs[P256_LIMBS], rhs[P256_LIMBS], t[P256_LIMBS];
+
+    fp_mul(lhs, p->y, p->y);
+
+    fp_mul(rhs, p->x, p->x);
+    fp_mul(rhs, rhs, p->x);
+    fp_add(t, p->x, p->x);
+    fp_add(t, t, p->x);
+    fp_sub(rhs, rhs, t);
+    fp_add(rhs, rhs, curve_b);
+
+    fp_sub(t, lhs, rhs);
+    return int_is_zero(t);
+}
+
+/**
+ * @brief ECDSA-P256验签
+ * 
+ * @param pubkey 未压缩公钥 x || y
+ * @param digest 消息摘要，SHA-256
+ * @param sig    签名 r || s
+ * @return true 签名有效
+ * @return false 
+ */
+bool p256_verify(const uint8_t pubkey[P256_KEY_SIZE], const uint8_t digest[P256_DIGEST_SIZE],
+                 const uint8_t sig[P256_SIG_SIZE])
+{
+    uint32_t r[P256_LIMBS], s[P256_LIMBS], e[P256_LIMBS], w[P256_LIMBS];
+    uint32_t u1[P256_LIMBS], u2[P256_LIMBS], x[P256_LIMBS];
+    p256_point_t table[4], acc, t;
+
+    // 公钥
+    int_from_bytes(table[2].x, pubkey);
+    int_from_bytes(table[2].y, pubkey + 32);
+    if (!int_less(table[2].x, mod_p.m) || !int_less(table[2].y, mod_p.m))
+    {
+        return false;
+    }
+    fp_mul(table[2].x, table[2].x, mod_p.rr);
+    fp_mul(table[2].y, table[2].y, mod_p.rr);
+    int_copy(table[2].z, mod_p.one);
+    if (!point_on_curve(&table[2]))
+    {
+        return false;
+    }
+
+    // 签名 r、s 须在 [1, n-1]
+    int_from_bytes(r, sig);
+    int_from_bytes(s, sig + 32);
+    if (int_is_zero(r) || int_is_zero(s) || !int_less(r, mod_n.m) || !int_less(s, mod_n.m))
+    {
+        return false;
+    }
+
+    // e = digest mod n
+    int_from_bytes(e, digest);
+    if (!int_less(e, mod_n.m))
+    {
+        mod_sub(e, e, mod_n.m, &mod_n);
+    }
+
+    // w = s^-1，u1 = e * w，u2 = r * w
+    mont_mul(w, s, mod_n.rr, &mod_n);
+    mod_inv(w, w, &mod_n);
+    mont_mul(u1, e, w, &mod_n);
+    mont_mul(u2, r, w, &mod_n);
+
+    // table[i] = (i & 1) * G + (i >> 1) * Q，table[0]仅作占位，使每一位都做一次点加
+    table[0] = curve_g;
+    table[1] = curve_g;
+    point_add(&table[3], &table[1], &table[2]);
+
+    int_copy(acc.x, mod_p.one);
+    int_copy(acc.y, mod_p.one);
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        acc.z[i] = 0;
+    }
+
+    for (int32_t i = 255; i >= 0; i--)
+    {
+        uint32_t idx = ((u1[i / 32] >> (i % 32)) & 1) | (((u2[i / 32] >> (i % 32)) & 1) << 1);
+
+        point_double(&acc, &acc);
+        point_add(&t, &acc, &table[idx]);
+        point_select(&acc, &t, -(uint32_t)(idx != 0));
+    }
+
+    if (int_is_zero(acc.z))
+    {
+        return false;
+    }
+
+    // 仿射x = X / Z^2，转回普通域后对n取模
+    mod_inv(x, acc.z, &mod_p);
+    fp_mul(x, x, x);
+    fp_mul(x, acc.x, x);
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        e[i] = i == 0;
+    }
+    fp_mul(x, x, e);
+    if (!int_less(x, mod_n.m))
+    {
+        mod_sub(x, x, mod_n.m, &mod_n);
+    }
+
+    for (uint32_t i = 0; i < P256_LIMBS; i++)
+    {
+        if (x[i] != r[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef __P256_H
+#define __P256_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#define P256_KEY_SIZE           64      // 公钥 x || y，大端
+#define P256_SIG_SIZE           64      // 签名 r || s，大端
+#define P256_DIGEST_SIZE        32
+
+
+bool p256_verify(const uint8_t pubkey[P256_KEY_SIZE], const uint8_t digest[P256_DIGEST_SIZE],
+                 const uint8_t sig[P256_SIG_SIZE]);
+
+
+#endif /* __P256_H */
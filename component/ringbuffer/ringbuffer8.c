@@ -3,44 +3,96 @@
 #include "ringbuffer8.h"
 
 
-#define rbb_len         rb->length
-// #define rbb_idx(x)      (uint8_t *)rbb_buff + rbb_size * (x)
-// #define dat_idx(d, x)   (uint8_t *)(d) + rbb_size * (x)
+#define rbb_mask        rb->mask
+#define rbb_len         (rb->mask + 1)
+
+// 单生产者/单消费者：只有写端修改head，只有读端修改tail
+// 读对端索引用acquire，保证之后访问的数据已由对端写完/读完；
+// 写自身索引用release，保证之前的数据访问先于索引对对端可见。
+// Cortex-M4上两者都编译为DMB + LDR/STR
+#define load_own(x)     __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define load_peer(x)    __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define store_own(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
 
 struct ringbuffer8
 {
-    uint32_t tail;   // 读指针
-    uint32_t head;   // 写指针
-    uint32_t length; // buffer可存储的字节数-这里data刚好是1Byte，即buffer长度
+    uint32_t tail;   // 读计数，自由递增，取模后为读位置
+    uint32_t head;   // 写计数，自由递增，取模后为写位置
+    uint32_t mask;   // buffer长度-1，长度为2的幂
+
+    // 统计，仅写端更新
+    uint32_t peak;
+    uint32_t overflows;
+    uint32_t dropped;
 
     uint8_t buffer[];
 };
 
+_Static_assert(sizeof(struct ringbuffer8) == RB8_HEADER_SIZE, "RB8_HEADER_SIZE mismatch");
+
+/**
+ * @brief 写端记录一次写入：used为写入后的占用量，lost为因空间不足未写入的字节数
+ */
+static inline void rb8_account(ringbuffer8_t rb, uint32_t used, uint32_t lost)
+{
+    if (used > rb->peak)
+        rb->peak = used;
+
+    if (lost)
+    {
+        rb->overflows++;
+        rb->dropped += lost;
+    }
+}
+
 /**
- * @brief ringBuffer初始化
+ * @brief ringBuffer初始化，可用容量向下取整为2的幂
  *
- * @param buff
- * @param length
+ * @param buff   4字节对齐的缓存，建议用RB8_BUFFER_SIZE(n)定义
+ * @param length 缓存总字节数，含控制头
  * @return ringbuffer8_t 结构体指针
  */
 ringbuffer8_t rb8_new(uint8_t *buff, uint32_t length)
 {
     ringbuffer8_t rb = (ringbuffer8_t)buff;           // rb指向外部传入进来的一块连续的数组空间
-    rb->length = length - sizeof(struct ringbuffer8); // 明确buffer的最大容量，防止内存踩踏
+    uint32_t capacity = length - sizeof(struct ringbuffer8);
+
+    // 明确buffer的最大容量，防止内存踩踏
+    while (capacity & (capacity - 1))
+    {
+        capacity &= capacity - 1;
+    }
+
+    rb->mask = capacity - 1;
     rb->head = 0;
     rb->tail = 0;
+    rb->peak = 0;
+    rb->overflows = 0;
+    rb->dropped = 0;
 
     return rb;
 }
 
-static inline uint16_t next_head(ringbuffer8_t rb)
+/**
+ * @brief 可读字节数，两端都可调用
+ *
+ * @param rb
+ * @return uint32_t
+ */
+uint32_t rb8_count(ringbuffer8_t rb)
 {
-    return rb->head + 1 < rbb_len ? rb->head + 1 : 0;
+    return load_peer(rb->head) - load_peer(rb->tail);
 }
 
-static inline uint16_t next_tail(ringbuffer8_t rb)
+/**
+ * @brief 可写字节数，两端都可调用
+ *
+ * @param rb
+ * @return uint32_t
+ */
+uint32_t rb8_free(ringbuffer8_t rb)
 {
-    return rb->tail + 1 < rbb_len ? rb->tail + 1 : 0;
+    return rbb_len - rb8_count(rb);
 }
 
 /**
@@ -52,7 +104,7 @@ static inline uint16_t next_tail(ringbuffer8_t rb)
  */
 bool rb8_empty(ringbuffer8_t rb)
 {
-    return rb->head == rb->tail;
+    return rb8_count(rb) == 0;
 }
 
 /**
@@ -64,11 +116,11 @@ bool rb8_empty(ringbuffer8_t rb)
  */
 bool rb8_full(ringbuffer8_t rb)
 {
-    return next_head(rb) == rb->tail;
+    return rb8_count(rb) == rbb_len;
 }
 
 /**
- * @brief rb8写一字节数据
+ * @brief rb8写一字节数据，仅写端调用
  *
  * @param rb
  * @param data
@@ -77,39 +129,55 @@ bool rb8_full(ringbuffer8_t rb)
  */
 bool rb8_put(ringbuffer8_t rb, uint8_t data)
 {
-    if (next_head(rb) == rb->tail)
-        // printf("ringbuffer overflow");
+    uint32_t head = load_own(rb->head);
+    uint32_t used = head - load_peer(rb->tail);
+
+    if (used == rbb_len)
+    {
+        rb8_account(rb, used, 1);
         return false;
+    }
 
-    rb->buffer[rb->head] = data;
-    rb->head = next_head(rb);
+    rb->buffer[head & rbb_mask] = data;
+    store_own(rb->head, head + 1);
+    rb8_account(rb, used + 1, 0);
 
     return true;
 }
 
 /**
- * @brief rb8写数据
+ * @brief rb8写数据，仅写端调用；空间不足时只写入能放下的部分，回绕处最多分两段拷贝
  *
  * @param rb
  * @param data
  * @param size
- * @return true
- * @return false
+ * @return uint32_t 实际写入的字节数
  */
-bool rb8_puts(ringbuffer8_t rb, uint8_t *data, uint32_t size)
+uint32_t rb8_puts(ringbuffer8_t rb, const uint8_t *data, uint32_t size)
 {
-    bool ret = true;
+    uint32_t head = load_own(rb->head);
+    uint32_t used = head - load_peer(rb->tail);
+    uint32_t n = rbb_len - used;
 
-    for (uint16_t i = 0; i < size && ret; i++)
-    {
-        ret = rb8_put(rb, data[i]);
-    }
+    if (size < n)
+        n = size;
+
+    uint32_t offset = head & rbb_mask;
+    uint32_t first = rbb_len - offset;
+    if (first > n)
+        first = n;
+
+    memcpy(&rb->buffer[offset], data, first);
+    memcpy(&rb->buffer[0], data + first, n - first);
 
-    return ret;
+    store_own(rb->head, head + n);
+    rb8_account(rb, used + n, size - n);
+
+    return n;
 }
 
 /**
- * @brief rb8取一字节数据
+ * @brief rb8取一字节数据，仅读端调用
  *
  * @param rb
  * @param data
@@ -118,32 +186,135 @@ bool rb8_puts(ringbuffer8_t rb, uint8_t *data, uint32_t size)
  */
 bool rb8_get(ringbuffer8_t rb, uint8_t *data)
 {
-    if (rb->head == rb->tail)
+    uint32_t tail = load_own(rb->tail);
+
+    if (load_peer(rb->head) == tail)
         return false;
 
-    *data = rb->buffer[rb->tail];
-    rb->tail = next_tail(rb);
+    *data = rb->buffer[tail & rbb_mask];
+    store_own(rb->tail, tail + 1);
 
     return true;
 }
 
 /**
- * @brief rb8取数据
+ * @brief rb8取数据，仅读端调用；数据不足时只取出已有的部分，回绕处最多分两段拷贝
  *
  * @param rb
  * @param data
  * @param size
- * @return true
- * @return false
+ * @return uint32_t 实际取出的字节数
  */
-bool rb8_gets(ringbuffer8_t rb, uint8_t *data, uint32_t size)
+uint32_t rb8_gets(ringbuffer8_t rb, uint8_t *data, uint32_t size)
 {
-    bool ret = true;
+    uint32_t tail = load_own(rb->tail);
+    uint32_t n = load_peer(rb->head) - tail;
 
-    for (uint16_t i = 0; i < size && ret; i++)
-    {
-        ret = rb8_get(rb, &data[i]);
-    }
+    if (size < n)
+        n = size;
+
+    uint32_t offset = tail & rbb_mask;
+    uint32_t first = rbb_len - offset;
+    if (first > n)
+        first = n;
+
+    memcpy(data, &rb->buffer[offset], first);
+    memcpy(data + first, &rb->buffer[0], n - first);
+
+    store_own(rb->tail, tail + n);
+
+    return n;
+}
+
+/**
+ * @brief 取得从读位置开始的连续可读区，仅读端调用；处理完后调用rb8_consume
+ *
+ * @param rb
+ * @param data 输出连续区起始地址
+ * @return uint32_t 连续可读字节数，回绕处只返回到缓存末尾的部分
+ */
+uint32_t rb8_peek_span(ringbuffer8_t rb, uint8_t **data)
+{
+    uint32_t tail = load_own(rb->tail);
+    uint32_t n = load_peer(rb->head) - tail;
+    uint32_t offset = tail & rbb_mask;
+
+    if (n > rbb_len - offset)
+        n = rbb_len - offset;
+
+    *data = &rb->buffer[offset];
+
+    return n;
+}
+
+/**
+ * @brief 释放已处理的数据，size不得超过rb8_peek_span返回值
+ *
+ * @param rb
+ * @param size
+ */
+void rb8_consume(ringbuffer8_t rb, uint32_t size)
+{
+    store_own(rb->tail, load_own(rb->tail) + size);
+}
+
+/**
+ * @brief 取得从写位置开始的连续可写区，仅写端调用；写入后调用rb8_commit
+ *
+ * @param rb
+ * @param data 输出连续区起始地址
+ * @return uint32_t 连续可写字节数，回绕处只返回到缓存末尾的部分
+ */
+uint32_t rb8_reserve_span(ringbuffer8_t rb, uint8_t **data)
+{
+    uint32_t head = load_own(rb->head);
+    uint32_t n = rbb_len - (head - load_peer(rb->tail));
+    uint32_t offset = head & rbb_mask;
+
+    if (n > rbb_len - offset)
+        n = rbb_len - offset;
+
+    *data = &rb->buffer[offset];
 
-    return ret;
+    return n;
+}
+
+/**
+ * @brief 提交已写入的数据，size不得超过rb8_reserve_span返回值
+ *
+ * @param rb
+ * @param size
+ */
+void rb8_commit(ringbuffer8_t rb, uint32_t size)
+{
+    uint32_t head = load_own(rb->head) + size;
+
+    store_own(rb->head, head);
+    rb8_account(rb, head - load_peer(rb->tail), 0);
+}
+
+/**
+ * @brief 读取统计，两端都可调用；与写端并发时各字段可能不是同一时刻的值
+ *
+ * @param rb
+ * @param stats
+ */
+void rb8_stats(ringbuffer8_t rb, rb8_stats_t *stats)
+{
+    stats->capacity = rbb_len;
+    stats->peak = rb->peak;
+    stats->overflows = rb->overflows;
+    stats->dropped = rb->dropped;
+}
+
+/**
+ * @brief 清除统计，峰值从当前占用量重新开始；需在写端不会同时写入时调用
+ *
+ * @param rb
+ */
+void rb8_stats_clear(ringbuffer8_t rb)
+{
+    rb->peak = rb8_count(rb);
+    rb->overflows = 0;
+    rb->dropped = 0;
 }
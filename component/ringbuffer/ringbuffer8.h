@@ -6,17 +6,51 @@
 #include <stdint.h>
 
 
+/*
+ * 单生产者/单消费者(SPSC)无锁环形缓冲区
+ *
+ * - 同一个rb只能有一个写端(put/puts)和一个读端(get/gets)，
+ *   两端可分别位于中断和主循环中，无需关中断；
+ * - 多个写端或多个读端(例如主循环和中断都写)需调用方自行互斥；
+ * - count/free/empty/full两端都可调用，结果是调用时刻的快照：
+ *   对写端而言free只会变大，对读端而言count只会变大。
+ */
+
+#define RB8_HEADER_SIZE         24
+#define RB8_BUFFER_SIZE(n)      ((n) + RB8_HEADER_SIZE)     // n需为2的幂
+
+
 struct ringbuffer8;
 typedef struct ringbuffer8 *ringbuffer8_t;
 
+// 统计信息：写入时空间不足记一次溢出，未写入的字节计入丢弃
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t peak;                      // 最大占用字节数
+    uint32_t overflows;
+    uint32_t dropped;
+} rb8_stats_t;
+
 
 ringbuffer8_t rb8_new(uint8_t *buff, uint32_t length);
 bool rb8_empty(ringbuffer8_t rb);
 bool rb8_full(ringbuffer8_t rb);
+uint32_t rb8_count(ringbuffer8_t rb);
+uint32_t rb8_free(ringbuffer8_t rb);
 bool rb8_put(ringbuffer8_t rb, uint8_t data);
-bool rb8_puts(ringbuffer8_t rb, uint8_t *data, uint32_t size);
+uint32_t rb8_puts(ringbuffer8_t rb, const uint8_t *data, uint32_t size);
 bool rb8_get(ringbuffer8_t rb, uint8_t *data);
-bool rb8_gets(ringbuffer8_t rb, uint8_t *data, uint32_t size);
+uint32_t rb8_gets(ringbuffer8_t rb, uint8_t *data, uint32_t size);
+
+// 零拷贝接口：读端peek后就地处理再consume，写端(如DMA)reserve后写入再commit
+uint32_t rb8_peek_span(ringbuffer8_t rb, uint8_t **data);
+void rb8_consume(ringbuffer8_t rb, uint32_t size);
+uint32_t rb8_reserve_span(ringbuffer8_t rb, uint8_t **data);
+void rb8_commit(ringbuffer8_t rb, uint32_t size);
+
+void rb8_stats(ringbuffer8_t rb, rb8_stats_t *stats);
+void rb8_stats_clear(ringbuffer8_t rb);
 
 
 #endif /* __RINGBUFFER8_H */
@@ -0,0 +1,117 @@
+#ifndef __RINGQUEUE_H
+#define __RINGQUEUE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*
+ * 定长元素环形队列，由宏按元素类型生成，容量编译期确定，不使用堆
+ *
+ * RQ_DEFINE(name, type, depth) 生成类型name_t及以下static inline函数：
+ *   name_init / name_count / name_free / name_empty / name_full
+ *   name_push / name_pop / name_peek / name_push_n / name_pop_n
+ *
+ * - depth必须为2的幂，head/tail自由递增，取模后为位置，满时不浪费元素；
+ * - 与ringbuffer8相同的SPSC约定：一个写端(push)和一个读端(pop/peek)，
+ *   可分别位于中断和主循环中，对端索引acquire读取、自身索引release写入；
+ * - 元素按值拷贝，大元素建议存放指针或索引。
+ */
+
+#define RQ_LOAD_OWN(x)      __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define RQ_LOAD_PEER(x)     __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define RQ_STORE_OWN(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+#define RQ_DEFINE(name, type, depth)                                                \
+                                                                                    \
+_Static_assert((depth) > 0 && ((depth) & ((depth) - 1)) == 0,                       \
+               #name " depth must be a power of two");                              \
+                                                                                    \
+typedef struct                                                                      \
+{                                                                                   \
+    uint32_t tail;                                                                  \
+    uint32_t head;                                                                  \
+    type items[depth];                                                              \
+} name##_t;                                                                         \
+                                                                                    \
+static inline void name##_init(name##_t *q)                                         \
+{                                                                                   \
+    q->tail = 0;                                                                    \
+    q->head = 0;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline uint32_t name##_count(name##_t *q)                                    \
+{                                                                                   \
+    return RQ_LOAD_PEER(q->head) - RQ_LOAD_PEER(q->tail);                           \
+}                                                                                   \
+                                                                                    \
+static inline uint32_t name##_free(name##_t *q)                                     \
+{                                                                                   \
+    return (depth) - name##_count(q);                                               \
+}                                                                                   \
+                                                                                    \
+static inline bool name##_empty(name##_t *q)                                        \
+{                                                                                   \
+    return name##_count(q) == 0;                                                    \
+}                                                                                   \
+                                                                                    \
+static inline bool name##_full(name##_t *q)                                         \
+{                                                                                   \
+    return name##_count(q) == (depth);                                              \
+}                                                                                   \
+                                                                                    \
+static inline bool name##_push(name##_t *q, type const *item)                       \
+{                                                                                   \
+    uint32_t head = RQ_LOAD_OWN(q->head);                                           \
+    if (head - RQ_LOAD_PEER(q->tail) == (depth))                                    \
+        return false;                                                               \
+    q->items[head & ((depth) - 1)] = *item;                                         \
+    RQ_STORE_OWN(q->head, head + 1);                                                \
+    return true;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline bool name##_pop(name##_t *q, type *item)                              \
+{                                                                                   \
+    uint32_t tail = RQ_LOAD_OWN(q->tail);                                           \
+    if (RQ_LOAD_PEER(q->head) == tail)                                              \
+        return false;                                                               \
+    *item = q->items[tail & ((depth) - 1)];                                         \
+    RQ_STORE_OWN(q->tail, tail + 1);                                                \
+    return true;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline type *name##_peek(name##_t *q)                                        \
+{                                                                                   \
+    uint32_t tail = RQ_LOAD_OWN(q->tail);                                           \
+    if (RQ_LOAD_PEER(q->head) == tail)                                              \
+        return 0;                                                                   \
+    return &q->items[tail & ((depth) - 1)];                                         \
+}                                                                                   \
+                                                                                    \
+static inline uint32_t name##_push_n(name##_t *q, type const *items, uint32_t n)    \
+{                                                                                   \
+    uint32_t head = RQ_LOAD_OWN(q->head);                                           \
+    uint32_t room = (depth) - (head - RQ_LOAD_PEER(q->tail));                       \
+    if (n > room)                                                                   \
+        n = room;                                                                   \
+    for (uint32_t i = 0; i < n; i++)                                                \
+        q->items[(head + i) & ((depth) - 1)] = items[i];                            \
+    RQ_STORE_OWN(q->head, head + n);                                                \
+    return n;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline uint32_t name##_pop_n(name##_t *q, type *items, uint32_t n)           \
+{                                                                                   \
+    uint32_t tail = RQ_LOAD_OWN(q->tail);                                           \
+    uint32_t avail = RQ_LOAD_PEER(q->head) - tail;                                  \
+    if (n > avail)                                                                  \
+        n = avail;                                                                  \
+    for (uint32_t i = 0; i < n; i++)                                                \
+        items[i] = q->items[(tail + i) & ((depth) - 1)];                            \
+    RQ_STORE_OWN(q->tail, tail + n);                                                \
+    return n;                                                                       \
+}
+
+
+#endif /* __RINGQUEUE_H */
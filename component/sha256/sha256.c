@@ -0,0 +1,204 @@
+#include "sha256.h"
+
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define S0(x)           (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define S1(x)           (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define s0(x)           (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define s1(x)           (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+#define CH(x, y, z)     ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)    (((x) & (y)) | ((z) & ((x) | (y))))
+
+// 消息扩展只保留16个字的滑动窗口
+#define W(i)            w[(i) & 15]
+#define EXPAND(i)       (W(i) += s1(W((i) - 2)) + W((i) - 7) + s0(W((i) - 15)))
+
+// 轮函数不搬移a~h，而是轮换宏参数，使8个工作变量始终留在寄存器中
+#define ROUND(a, b, c, d, e, f, g, h, k, x)                 \
+    do                                                      \
+    {                                                       \
+        uint32_t t = h + S1(e) + CH(e, f, g) + (k) + (x);   \
+        d += t;                                             \
+        h = t + S0(a) + MAJ(a, b, c);                       \
+    } while (0)
+
+#define ROUND8(i, x)                                        \
+    do                                                      \
+    {                                                       \
+        ROUND(a, b, c, d, e, f, g, h, K[(i) + 0], x((i) + 0)); \
+        ROUND(h, a, b, c, d, e, f, g, K[(i) + 1], x((i) + 1)); \
+        ROUND(g, h, a, b, c, d, e, f, K[(i) + 2], x((i) + 2)); \
+        ROUND(f, g, h, a, b, c, d, e, K[(i) + 3], x((i) + 3)); \
+        ROUND(e, f, g, h, a, b, c, d, K[(i) + 4], x((i) + 4)); \
+        ROUND(d, e, f, g, h, a, b, c, K[(i) + 5], x((i) + 5)); \
+        ROUND(c, d, e, f, g, h, a, b, K[(i) + 6], x((i) + 6)); \
+        ROUND(b, c, d, e, f, g, h, a, K[(i) + 7], x((i) + 7)); \
+    } while (0)
+
+
+static const uint32_t K[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+/**
+ * @brief 压缩函数，一次处理nblocks个64字节分组
+ * 
+ * @param state 
+ * @param data 
+ * @param nblocks 
+ */
+static void sha256_transform(uint32_t state[8], const uint8_t *data, uint32_t nblocks)
+{
+    uint32_t w[16];
+
+    while (nblocks--)
+    {
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            w[i] = load_be32(data + i * 4);
+        }
+
+        // 前16轮直接使用消息字，后48轮边扩展边计算
+        #define LOAD(i)     W(i)
+        ROUND8(0, LOAD);
+        ROUND8(8, LOAD);
+        #undef LOAD
+
+        for (uint32_t i = 16; i < 64; i += 16)
+        {
+            ROUND8(i, EXPAND);
+            ROUND8(i + 8, EXPAND);
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+
+        data += SHA256_BLOCK_SIZE;
+    }
+}
+
+void sha256_init(sha256_ctx_t *ctx)
+{
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+    ctx->total = 0;
+    ctx->buflen = 0;
+}
+
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t len)
+{
+    ctx->total += len;
+
+    if (ctx->buflen)
+    {
+        while (len && ctx->buflen < SHA256_BLOCK_SIZE)
+        {
+            ctx->buffer[ctx->buflen++] = *data++;
+            len--;
+        }
+
+        if (ctx->buflen < SHA256_BLOCK_SIZE)
+        {
+            return;
+        }
+
+        sha256_transform(ctx->state, ctx->buffer, 1);
+        ctx->buflen = 0;
+    }
+
+    // 整块数据直接在原地压缩，不经过缓冲区
+    if (len >= SHA256_BLOCK_SIZE)
+    {
+        sha256_transform(ctx->state, data, len / SHA256_BLOCK_SIZE);
+        data += len & ~(SHA256_BLOCK_SIZE - 1);
+        len &= SHA256_BLOCK_SIZE - 1;
+    }
+
+    while (len--)
+    {
+        ctx->buffer[ctx->buflen++] = *data++;
+    }
+}
+
+void sha256_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    uint32_t bits_hi = ctx->total >> 29;
+    uint32_t bits_lo = ctx->total << 3;
+
+    ctx->buffer[ctx->buflen++] = 0x80;
+    if (ctx->buflen > SHA256_BLOCK_SIZE - 8)
+    {
+        while (ctx->buflen < SHA256_BLOCK_SIZE)
+        {
+            ctx->buffer[ctx->buflen++] = 0;
+        }
+        sha256_transform(ctx->state, ctx->buffer, 1);
+        ctx->buflen = 0;
+    }
+
+    while (ctx->buflen < SHA256_BLOCK_SIZE - 8)
+    {
+        ctx->buffer[ctx->buflen++] = 0;
+    }
+    store_be32(ctx->buffer + 56, bits_hi);
+    store_be32(ctx->buffer + 60, bits_lo);
+    sha256_transform(ctx->state, ctx->buffer, 1);
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        store_be32(digest + i * 4, ctx->state[i]);
+    }
+}
+
+/**
+ * @brief 计算一段数据的SHA-256，开启SHA256_USE_HASH时使用HASH外设
+ * 
+ * @param data 
+ * @param len 
+ * @param digest 
+ */
+void sha256(const uint8_t *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+#if SHA256_USE_HASH
+    sha256_hw(data, len, digest);
+#else
+    sha256_ctx_t ctx;
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, digest);
+#endif
+}
@@ -0,0 +1,31 @@
+#ifndef __SHA256_H
+#define __SHA256_H
+
+
+#include <stdint.h>
+
+
+#define SHA256_BLOCK_SIZE       64
+#define SHA256_DIGEST_SIZE      32
+
+
+typedef struct
+{
+    uint32_t state[8];
+    uint32_t total;                         // 已输入的字节数，固件不超过4GB
+    uint32_t buflen;
+    uint8_t buffer[SHA256_BLOCK_SIZE];
+} sha256_ctx_t;
+
+
+void sha256_init(sha256_ctx_t *ctx);
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t len);
+void sha256_final(sha256_ctx_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+void sha256(const uint8_t *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#if SHA256_USE_HASH
+void sha256_hw(const uint8_t *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE]);
+#endif
+
+
+#endif /* __SHA256_H */
@@ -0,0 +1,109 @@
+#include "sha256.h"
+
+#if SHA256_USE_HASH
+
+#if !defined(STM32F427_437xx) && !defined(STM32F429_439xx)
+#error "HASH peripheral supports SHA-256 only on STM32F43x (build with CONFIG_MCU=STM32F427_437xx or STM32F429_439xx)"
+#endif
+
+#include "stm32f4xx.h"
+
+
+#define HASH_DMA_STREAM         DMA2_Stream7
+#define HASH_DMA_CHANNEL        DMA_Channel_2
+#define HASH_DMA_FLAG_TC        DMA_FLAG_TCIF7
+#define HASH_DMA_FLAG_TE        DMA_FLAG_TEIF7
+// 单次DMA传输不超过65535个字，中间传输须为64字节分组的整数倍
+#define HASH_DMA_CHUNK_WORDS    0xFFF0ul
+
+
+static void hash_dma_transfer(const uint32_t *data, uint32_t words)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(HASH_DMA_STREAM);
+    DMA_InitStructure.DMA_Channel = HASH_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&HASH->DIN;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)data;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = words;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Enable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_HalfFull;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(HASH_DMA_STREAM, &DMA_InitStructure);
+
+    // DMAE在每次传输结束后由硬件清零，需逐次重新使能
+    HASH_DMACmd(ENABLE);
+    DMA_Cmd(HASH_DMA_STREAM, ENABLE);
+
+    while (DMA_GetFlagStatus(HASH_DMA_STREAM, HASH_DMA_FLAG_TC | HASH_DMA_FLAG_TE) == RESET);
+    DMA_ClearFlag(HASH_DMA_STREAM, HASH_DMA_FLAG_TC | HASH_DMA_FLAG_TE);
+}
+
+/**
+ * @brief 使用HASH外设+DMA计算SHA-256，数据由DMA直接从Flash/SRAM搬入HASH，CPU只等待结束
+ * 
+ * @param data 起始地址须4字节对齐
+ * @param len 
+ * @param digest 
+ */
+void sha256_hw(const uint8_t *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    HASH_InitTypeDef HASH_InitStructure;
+    HASH_MsgDigest msg_digest;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_HASH, ENABLE);
+
+    HASH_DeInit();
+    HASH_StructInit(&HASH_InitStructure);
+    HASH_InitStructure.HASH_AlgoSelection = HASH_AlgoSelection_SHA256;
+    HASH_InitStructure.HASH_DataType = HASH_DataType_8b;
+    HASH_Init(&HASH_InitStructure);
+
+    // 最后一个字中的有效位数，末尾不足4字节的部分由DMA多读的字节不参与计算
+    HASH_SetLastWordValidBitsNbr(8 * (len % 4));
+
+    const uint32_t *words = (const uint32_t *)data;
+    uint32_t remain = (len + 3) / 4;
+
+    if (remain == 0)
+    {
+        HASH_StartDigest();
+    }
+
+    while (remain)
+    {
+        uint32_t chunk = remain > HASH_DMA_CHUNK_WORDS ? HASH_DMA_CHUNK_WORDS : remain;
+
+        // 最后一次传输结束后由硬件自动填充并计算摘要
+        HASH_AutoStartDigest(chunk == remain ? ENABLE : DISABLE);
+        hash_dma_transfer(words, chunk);
+
+        words += chunk;
+        remain -= chunk;
+    }
+
+    while (HASH_GetFlagStatus(HASH_FLAG_DCIS) == RESET);
+    HASH_GetDigest(&msg_digest);
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        uint32_t v = msg_digest.Data[i];
+        digest[i * 4 + 0] = v >> 24;
+        digest[i * 4 + 1] = v >> 16;
+        digest[i * 4 + 2] = v >> 8;
+        digest[i * 4 + 3] = v;
+    }
+
+    RCC_AHB2PeriphClockCmd(RCC_AHB2Periph_HASH, DISABLE);
+}
+
+#endif /* SHA256_USE_HASH */
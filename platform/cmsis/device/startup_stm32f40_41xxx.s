@@ -71,34 +71,99 @@ defined in linker script */
   .type  Reset_Handler, %function
 Reset_Handler:  
 
-/* Copy the data segment initializers from flash to SRAM */  
+/* Enable and clear the DWT cycle counter, boot stage stamps count from reset */
+  ldr  r0, =0xE000EDFC    /* CoreDebug->DEMCR */
+  ldr  r1, [r0]
+  orr  r1, r1, #0x01000000  /* TRCENA */
+  str  r1, [r0]
+  ldr  r0, =0xE0001000    /* DWT->CTRL */
   movs  r1, #0
+  str  r1, [r0, #4]        /* DWT->CYCCNT */
+  ldr  r1, [r0]
+  orr  r1, r1, #1          /* CYCCNTENA */
+  str  r1, [r0]
+
+/* Copy the data segment initializers from flash to SRAM, 16 bytes per iteration */
+  ldr  r0, =_sdata
+  ldr  r1, =_edata
+  ldr  r2, =_sidata
+  b  LoopCopyDataInit16
+
+CopyDataInit16:
+  ldmia  r2!, {r3, r4, r5, r6}
+  stmia  r0!, {r3, r4, r5, r6}
+
+LoopCopyDataInit16:
+  subs  r7, r1, r0
+  cmp  r7, #16
+  bhs  CopyDataInit16
   b  LoopCopyDataInit
 
 CopyDataInit:
-  ldr  r3, =_sidata
-  ldr  r3, [r3, r1]
-  str  r3, [r0, r1]
-  adds  r1, r1, #4
-    
+  ldr  r3, [r2], #4
+  str  r3, [r0], #4
+
 LoopCopyDataInit:
-  ldr  r0, =_sdata
-  ldr  r3, =_edata
-  adds  r2, r0, r1
-  cmp  r2, r3
+  cmp  r0, r1
   bcc  CopyDataInit
-  ldr  r2, =_sbss
+
+/* Copy the .ccmram initializers from flash to CCM RAM */
+  ldr  r0, =_sccmram
+  ldr  r1, =_eccmram
+  ldr  r2, =_siccmram
+  b  LoopCopyCcmInit
+
+CopyCcmInit:
+  ldr  r3, [r2], #4
+  str  r3, [r0], #4
+
+LoopCopyCcmInit:
+  cmp  r0, r1
+  bcc  CopyCcmInit
+
+/* Zero fill the bss segment, 16 bytes per iteration. .noinit and .ccmnoinit are left untouched */
+  ldr  r0, =_sbss
+  ldr  r1, =_ebss
+  movs  r3, #0
+  movs  r4, #0
+  movs  r5, #0
+  movs  r6, #0
+  b  LoopFillZerobss16
+
+FillZerobss16:
+  stmia  r0!, {r3, r4, r5, r6}
+
+LoopFillZerobss16:
+  subs  r7, r1, r0
+  cmp  r7, #16
+  bhs  FillZerobss16
   b  LoopFillZerobss
-/* Zero fill the bss segment. */  
+
 FillZerobss:
-  movs  r3, #0
-  str  r3, [r2], #4
-    
+  str  r3, [r0], #4
+
 LoopFillZerobss:
-  ldr  r3, = _ebss
-  cmp  r2, r3
+  cmp  r0, r1
   bcc  FillZerobss
 
+/* Paint the top of the stack below the current SP, bl_stack_usage() scans it for the high-water mark */
+  ldr  r0, =_sstack_paint
+  mov  r1, sp
+  ldr  r3, =0xA5A5A5A5
+  b  LoopPaintStack
+
+PaintStack:
+  str  r3, [r0], #4
+
+LoopPaintStack:
+  cmp  r0, r1
+  bcc  PaintStack
+
+/* Stamp the end of memory initialization */
+  ldr  r0, =0xE0001004    /* DWT->CYCCNT */
+  ldr  r1, [r0]
+  ldr  r0, =bl_startup_cycles
+  str  r1, [r0]
 /* Call the clock system intitialization function.*/
   bl  SystemInit   
 /* Call the application's entry point.*/
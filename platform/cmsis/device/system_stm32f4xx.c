@@ -260,6 +260,7 @@
   */
 
 #include "stm32f4xx.h"
+#include "clock.h"
 
 /**
   * @}
@@ -349,6 +350,12 @@
 #define PLL_P      4   
 #endif /* STM32F411xx */
 
+/* bootloader: the flash wait states in clock.h are derived from BL_SYSCLK_HZ */
+#if (defined (STM32F40_41xxx) || defined (STM32F427_437xx) || defined (STM32F429_439xx)) && \
+    (HSE_VALUE / PLL_M * PLL_N / PLL_P != BL_SYSCLK_HZ)
+#error "PLL settings do not match BL_SYSCLK_HZ in clock.h"
+#endif
+
 /******************************************************************************/
 
 /**
@@ -445,7 +452,9 @@ void SystemInit(void)
          
   /* Configure the System clock source, PLL Multiplier and Divider factors, 
      AHB/APBx prescalers and Flash settings ----------------------------------*/
+#if !BL_CLOCK_LAZY_PLL
   SetSysClock();
+#endif /* BL_CLOCK_LAZY_PLL */
 
   /* Configure the Vector Table location add offset address ------------------*/
 #ifdef VECT_TAB_SRAM
@@ -455,6 +464,19 @@ void SystemInit(void)
 #endif
 }
 
+/**
+  * @brief  Configure the PLL as system clock source, as SystemInit does by default.
+  *         With BL_CLOCK_LAZY_PLL the core keeps running on HSI after reset and
+  *         the bootloader calls this only when it needs full speed.
+  * @note   Call SystemCoreClockUpdate() afterwards.
+  * @param  None
+  * @retval None
+  */
+void SystemClockConfig(void)
+{
+  SetSysClock();
+}
+
 /**
    * @brief  Update SystemCoreClock variable according to Clock Register Values.
   *         The SystemCoreClock variable contains the core clock (HCLK), it can
@@ -636,12 +658,12 @@ static void SetSysClock(void)
     {
     }      
     /* Configure Flash prefetch, Instruction cache, Data cache and wait state */
-    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |FLASH_ACR_LATENCY_5WS;
+    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |BL_SYSCLK_LATENCY;
 #endif /* STM32F427_437x || STM32F429_439xx  */
 
 #if defined (STM32F40_41xxx)     
-    /* Configure Flash prefetch, Instruction cache, Data cache and wait state */
-    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |FLASH_ACR_LATENCY_5WS;
+    /* Configure Flash prefetch, Instruction cache, Data cache and wait state (see BL_SYSCLK_LATENCY) */
+    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |BL_SYSCLK_LATENCY;
 #endif /* STM32F40_41xxx  */
 
 #if defined (STM32F401xx)
@@ -85,6 +85,7 @@ extern uint32_t SystemCoreClock;          /*!< System Clock Frequency (Core Cloc
   
 extern void SystemInit(void);
 extern void SystemCoreClockUpdate(void);
+extern void SystemClockConfig(void);
 /**
   * @}
   */
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+解析GNU ld生成的.map文件，按目录/符号统计text、rodata、data、bss、ccmram占用，
+超出预算时返回非0，使构建失败。
+
+用法：
+    footprint.py <map> [--build output/stm32f4_boot] [--flash-budget N] [--ram-budget N]
+                 [--ccm-budget N] [--symbols N] [--summary]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+CATEGORIES = ("text", "rodata", "data", "bss", "ccmram")
+
+# 输出段 -> 统计类别，None表示按输入段名区分text/rodata
+OUTPUT_SECTIONS = {
+    ".isr_vector": None,
+    ".text": None,
+    ".rodata": None,
+    ".ARM.extab": "rodata",
+    ".ARM": "rodata",
+    ".preinit_array": "rodata",
+    ".init_array": "rodata",
+    ".fini_array": "rodata",
+    ".data": "data",
+    ".bss": "bss",
+    ".noinit": "bss",
+    ".bootshare": "bss",
+    ".ccmram": "ccmram",
+    ".ccmnoinit": "ccmram",
+}
+
+# 只占RAM、不含输入段的保留段
+RESERVED_SECTIONS = ("._user_heap_stack",)
+
+RE_OUTPUT = re.compile(r"^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?")
+RE_INPUT = re.compile(r"^ (\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*))?$")
+RE_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def classify(output, name):
+    category = OUTPUT_SECTIONS.get(output, "skip")
+    if category is None:
+        return "rodata" if name.startswith(".rodata") else "text"
+    return category
+
+
+def module_of(path, build):
+    # 库成员 libc_nano.a(lib_a-memcpy.o) 归入库名
+    m = re.match(r"(.*?)\((.*)\)$", path)
+    if m:
+        return os.path.basename(m.group(1))
+    path = path.replace("\\", "/")
+    if build and path.startswith(build.rstrip("/") + "/"):
+        path = path[len(build.rstrip("/")) + 1:]
+    return os.path.dirname(path) or "."
+
+
+def symbol_of(name):
+    # -ffunction-sections/-fdata-sections下输入段名为 .text.<符号>
+    for prefix in (".text.", ".rodata.", ".data.", ".bss.", ".noinit.", ".ccmram.", ".ccmnoinit."):
+        if name.startswith(prefix):
+            return name[len(prefix):]
+    return name
+
+
+def parse(path, build):
+    entries = []
+    reserved = {}
+    output = None
+    pending = None
+
+    with open(path, encoding="utf-8", errors="replace") as f:
+        lines = iter(f.read().splitlines())
+
+    # 跳过Discarded input sections等前置内容
+    for line in lines:
+        if line.startswith("Linker script and memory map"):
+            break
+
+    for line in lines:
+        if pending is not None:
+            m = RE_CONT.match(line)
+            if m:
+                entries.append((output, pending, int(m.group(2), 16), m.group(3).strip()))
+            pending = None
+            continue
+
+        m = RE_OUTPUT.match(line)
+        if m:
+            output = m.group(1)
+            if output in RESERVED_SECTIONS and m.group(3):
+                reserved[output] = int(m.group(3), 16)
+            continue
+
+        m = RE_INPUT.match(line)
+        if not m or m.group(1).startswith("0x") or m.group(1) == "*fill*":
+            continue
+        if m.group(2) is None:
+            # 段名过长时地址和大小换到下一行
+            pending = m.group(1)
+            continue
+        entries.append((output, m.group(1), int(m.group(3), 16), m.group(4).strip()))
+
+    table = {}
+    symbols = []
+    for output, name, size, obj in entries:
+        category = classify(output, name)
+        if size == 0 or category == "skip":
+            continue
+        module = module_of(obj, build)
+        row = table.setdefault(module, dict.fromkeys(CATEGORIES, 0))
+        row[category] += size
+        symbols.append((size, category, symbol_of(name), module, name))
+
+    return table, symbols, reserved
+
+
+def main():
+    parser = argparse.ArgumentParser(description="per-module footprint report from a GNU ld map file")
+    parser.add_argument("map")
+    parser.add_argument("--build", default="", help="object directory prefix stripped from module paths")
+    parser.add_argument("--flash-budget", type=int, default=0, help="text+rodata+data+initialised ccmram, bytes")
+    parser.add_argument("--ram-budget", type=int, default=0, help="data+bss+stack/heap reserve, bytes")
+    parser.add_argument("--ccm-budget", type=int, default=0, help="ccmram, bytes")
+    parser.add_argument("--symbols", type=int, default=20, help="largest symbols to list, 0 for none")
+    parser.add_argument("--summary", action="store_true", help="print totals and budget check only")
+    args = parser.parse_args()
+
+    table, symbols, reserved = parse(args.map, args.build)
+
+    total = dict.fromkeys(CATEGORIES, 0)
+    for row in table.values():
+        for category in CATEGORIES:
+            total[category] += row[category]
+
+    if not args.summary:
+        header = "%-32s" % "module" + "".join("%9s" % c for c in CATEGORIES)
+        print(header)
+        print("-" * len(header))
+        for module in sorted(table, key=lambda k: -sum(table[k].values())):
+            print("%-32s" % module + "".join("%9d" % table[module][c] for c in CATEGORIES))
+        print("-" * len(header))
+        print("%-32s" % "total" + "".join("%9d" % total[c] for c in CATEGORIES))
+
+        if args.symbols:
+            print()
+            print("%8s  %-7s %-40s %s" % ("size", "type", "symbol", "module"))
+            for size, category, name, module, section in sorted(symbols, reverse=True)[:args.symbols]:
+                print("%8d  %-7s %-40s %s" % (size, category, name, module))
+        print()
+
+    # .ccmnoinit不占FLASH，只有.ccmram的初值需要拷贝
+    ccm_init = sum(size for size, category, name, module, section in symbols
+                   if category == "ccmram" and not section.startswith(".ccmnoinit"))
+    stack = sum(reserved.values())
+    usage = (
+        ("flash", total["text"] + total["rodata"] + total["data"] + ccm_init, args.flash_budget),
+        ("ram", total["data"] + total["bss"] + stack, args.ram_budget),
+        ("ccm", total["ccmram"], args.ccm_budget),
+    )
+
+    failed = False
+    for name, used, budget in usage:
+        if budget:
+            state = "OVER" if used > budget else "ok"
+            failed |= used > budget
+            print("  %-6s %8d / %8d bytes  %5.1f%%  %s" % (name, used, budget, 100.0 * used / budget, state))
+        else:
+            print("  %-6s %8d bytes" % (name, used))
+    if stack:
+        print("  (ram includes %d bytes of heap/stack reserve)" % stack)
+
+    if failed:
+        print("footprint budget exceeded", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
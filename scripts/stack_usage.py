@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+汇总GCC -fcallgraph-info=su生成的.ci文件，按调用图计算各入口的最坏栈深度及其调用路径。
+
+入口为main和所有*_Handler/*_IRQHandler；中断可互相抢占，保守估计为
+main最坏深度 + 各中断最坏深度之和 + 每次进入异常压栈的帧。
+
+无法静态确定的部分会列出：递归、函数指针调用、动态栈分配、没有.ci的外部函数(如libc)。
+
+用法：
+    stack_usage.py <build dir> [--root main] [--frame 104] [--limit N]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+RE_NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+RE_EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+RE_STACK = re.compile(r"(\d+) bytes \(([^)]*)\)")
+RE_HANDLER = re.compile(r"(^|:)\w+_(IRQ)?Handler$")
+
+INDIRECT = "__indirect_call"
+
+
+def load(build):
+    nodes = {}
+    edges = {}
+
+    for root, _, files in os.walk(build):
+        for name in files:
+            if not name.endswith(".ci"):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8", errors="replace") as f:
+                text = f.read()
+            for title, label in RE_NODE.findall(text):
+                m = RE_STACK.search(label)
+                if m:
+                    nodes[title] = (int(m.group(1)), m.group(2), label.split("\\n")[1] if "\\n" in label else "")
+            for source, target in RE_EDGE.findall(text):
+                edges.setdefault(source, []).append(target)
+
+    return nodes, edges
+
+
+def short(title):
+    # 静态函数的title为 file.c:func
+    return title.rsplit(":", 1)[-1]
+
+
+class Analyzer:
+    def __init__(self, nodes, edges):
+        self.nodes = nodes
+        self.edges = edges
+        self.memo = {}
+        self.recursive = set()
+        self.indirect = set()
+        self.dynamic = set()
+        self.unknown = set()
+
+    def worst(self, title, active=()):
+        """返回(最坏深度, 路径)"""
+        if title in self.memo:
+            return self.memo[title]
+        if title == INDIRECT:
+            return 0, []
+        if title not in self.nodes:
+            self.unknown.add(title)
+            return 0, [(title, None)]
+
+        size, kind, _ = self.nodes[title]
+        if kind != "static":
+            self.dynamic.add(title)
+
+        active = active + (title,)
+        best, best_path = 0, []
+        for callee in self.edges.get(title, []):
+            if callee == INDIRECT:
+                self.indirect.add(title)
+                continue
+            if callee in active:
+                self.recursive.add(title)
+                continue
+            depth, path = self.worst(callee, active)
+            if depth > best:
+                best, best_path = depth, path
+
+        result = (size + best, [(title, size)] + best_path)
+        # 处于递归环中的结果依赖调用顺序，不缓存
+        if title not in self.recursive:
+            self.memo[title] = result
+        return result
+
+
+def print_path(depth, path):
+    print("  worst case %d bytes" % depth)
+    for title, size in path:
+        if size is None:
+            print("    %8s  %s (no stack info)" % ("?", title))
+        else:
+            print("    %8d  %s" % (size, short(title)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="worst-case stack depth from GCC -fcallgraph-info=su output")
+    parser.add_argument("build", help="directory searched recursively for .ci files")
+    parser.add_argument("--root", default="main", help="main entry function")
+    parser.add_argument("--frame", type=int, default=104,
+                        help="bytes stacked on exception entry, 104 with lazy FPU context on Cortex-M4F")
+    parser.add_argument("--limit", type=int, default=0, help="fail when the estimate exceeds this many bytes")
+    args = parser.parse_args()
+
+    nodes, edges = load(args.build)
+    if not nodes:
+        print("no .ci files under %s, build with -fcallgraph-info=su" % args.build, file=sys.stderr)
+        return 1
+
+    analyzer = Analyzer(nodes, edges)
+
+    roots = [t for t in nodes if short(t) == args.root]
+    handlers = sorted(t for t in nodes if RE_HANDLER.search(t))
+
+    total = 0
+    for title in roots:
+        depth, path = analyzer.worst(title)
+        print("%s:" % short(title))
+        print_path(depth, path)
+        total += depth
+
+    isr_total = 0
+    for title in handlers:
+        depth, path = analyzer.worst(title)
+        if depth == 0:
+            continue
+        print("%s:" % short(title))
+        print_path(depth, path)
+        isr_total += depth + args.frame
+
+    total += isr_total
+    print()
+    print("estimate: %d bytes (%s + all handlers nested, %d bytes exception frame each)" %
+          (total, args.root, args.frame))
+
+    for name, items in (("recursion", analyzer.recursive),
+                        ("indirect calls", analyzer.indirect),
+                        ("dynamic stack", analyzer.dynamic),
+                        ("no stack info", analyzer.unknown)):
+        if items:
+            print("%s, not bounded by the estimate:" % name)
+            for title in sorted(items):
+                print("    %s" % title)
+
+    if args.limit and total > args.limit:
+        print("stack estimate %d exceeds limit %d" % (total, args.limit), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,61 @@
+#ifndef __TEST_H
+#define __TEST_H
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/*
+ * 主机端单元测试的最小断言集，失败时打印位置并计数，main返回test_failed
+ */
+
+static int test_failed;
+
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+            test_failed++;                                                      \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_MEM(a, b, n)      CHECK(memcmp((a), (b), (n)) == 0)
+
+#define TEST_DONE(name)                                                         \
+    (printf("%-12s %s\n", (name), test_failed ? "FAIL" : "ok"), test_failed ? 1 : 0)
+
+// 设置环境变量BENCH(或make bench)时各测试额外打印基准数据
+#define TEST_BENCH()            (getenv("BENCH") != NULL)
+
+// 单调时钟，单位ns，用于主机端基准测试
+static inline uint64_t test_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// 十六进制字符串转字节，返回字节数
+static inline size_t unhex(const char *hex, uint8_t *out)
+{
+    size_t n = 0;
+
+    for (; hex[0] && hex[1]; hex += 2)
+    {
+        unsigned int v;
+        sscanf(hex, "%2x", &v);
+        out[n++] = (uint8_t)v;
+    }
+
+    return n;
+}
+
+
+#endif /* __TEST_H */
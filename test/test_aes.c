@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include "test.h"
+#include "aes.h"
+
+
+// NIST SP 800-38A F.5.1 CTR-AES128.Encrypt 与 F.5.5 CTR-AES256.Encrypt
+static const char *ctr_counter = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+static const char *ctr_plain =
+    "6bc1bee22e409f96e93d7e117393172a" "ae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52ef" "f69f2445df4f9b17ad2b417be66c3710";
+
+static const struct
+{
+    const char *key;
+    uint32_t key_bits;
+    const char *cipher;
+} ctr_vectors[] =
+{
+    {
+        "2b7e151628aed2a6abf7158809cf4f3c", 128,
+        "874d6191b620e3261bef6864990db6ce" "9806f66b7970fdff8617187bb9fffdff"
+        "5ae4df3edbd5d35e5b4f09020db03eab" "1e031dda2fbe03d1792170a0f3009cee",
+    },
+    {
+        "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", 256,
+        "601ec313775789a5b7a7f504bbf3d228" "f443e3ca4d62b59aca84e990cacaf5c5"
+        "2b0930daa23de94ce87017ba2d84988d" "dfc9c58db67aada613c2dd08457941a6",
+    },
+};
+
+
+int main(void)
+{
+    uint8_t key[AES_KEY_SIZE_MAX], counter[AES_BLOCK_SIZE];
+    uint8_t plain[64], expect[64], data[64];
+    aes_ctx_t ctx;
+
+    // FIPS 197 C.1
+    uint8_t in[AES_BLOCK_SIZE], out[AES_BLOCK_SIZE], block[AES_BLOCK_SIZE];
+    unhex("000102030405060708090a0b0c0d0e0f", key);
+    unhex("00112233445566778899aabbccddeeff", in);
+    unhex("69c4e0d86a7b0430d8cdb78070b4c55a", block);
+    aes_setkey(&ctx, key, 128);
+    aes_encrypt_block(&ctx, in, out);
+    CHECK_MEM(out, block, AES_BLOCK_SIZE);
+
+    unhex(ctr_counter, counter);
+    unhex(ctr_plain, plain);
+
+    for (size_t i = 0; i < sizeof(ctr_vectors) / sizeof(ctr_vectors[0]); i++)
+    {
+        unhex(ctr_vectors[i].key, key);
+        unhex(ctr_vectors[i].cipher, expect);
+        aes_setkey(&ctx, key, ctr_vectors[i].key_bits);
+
+        // 加密
+        memcpy(data, plain, sizeof(data));
+        aes_ctr_xcrypt(&ctx, counter, data, sizeof(data));
+        CHECK_MEM(data, expect, sizeof(data));
+
+        // 解密
+        aes_ctr_xcrypt(&ctx, counter, data, sizeof(data));
+        CHECK_MEM(data, plain, sizeof(data));
+
+        // 非整块长度只处理前len字节，其余不变
+        for (uint32_t len = 1; len < sizeof(data); len += 7)
+        {
+            memcpy(data, plain, sizeof(data));
+            aes_ctr_xcrypt(&ctx, counter, data, len);
+            CHECK_MEM(data, expect, len);
+            CHECK_MEM(data + len, plain + len, sizeof(data) - len);
+        }
+
+        // 计数器低32位每块加1，...fdfeff 加2进位为 ...fdff01，等同于跳过前两块
+        uint8_t next[AES_BLOCK_SIZE];
+        memcpy(next, counter, sizeof(next));
+        next[14] = 0xff;
+        next[15] = 0x01;
+        memcpy(data, plain + 32, 32);
+        aes_ctr_xcrypt(&ctx, next, data, 32);
+        CHECK_MEM(data, expect + 32, 32);
+    }
+
+    return TEST_DONE("aes");
+}
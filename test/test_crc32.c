@@ -0,0 +1,46 @@
+#include <stdint.h>
+#include "test.h"
+#include "crc32.h"
+
+
+static uint8_t buf[70000];
+
+
+int main(void)
+{
+    // CRC-32/ISO-HDLC 校验值
+    CHECK(crc32_update(0, (uint8_t *)"123456789", 9) == 0xCBF43926);
+    CHECK(crc32_update(0, buf, 0) == 0);
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+
+    // 分段CRC组合后应等于整段CRC，含空段和跨越64KB的段
+    const uint32_t splits[] = { 0, 1, 3, 16, 511, 4096, 65536, 69999, 70000 };
+    uint32_t full = crc32_update(0, buf, sizeof(buf));
+
+    for (size_t i = 0; i < sizeof(splits) / sizeof(splits[0]); i++)
+    {
+        uint32_t n = splits[i];
+        uint32_t a = crc32_update(0, buf, n);
+        uint32_t b = crc32_update(0, buf + n, sizeof(buf) - n);
+        CHECK(crc32_combine(a, b, sizeof(buf) - n) == full);
+    }
+
+    // 按块清单的方式逐块组合
+    uint32_t crc = 0;
+    for (uint32_t off = 0; off < sizeof(buf); off += 2048)
+    {
+        uint32_t n = sizeof(buf) - off < 2048 ? sizeof(buf) - off : 2048;
+        crc = crc32_combine(crc, crc32_update(0, buf + off, n), n);
+    }
+    CHECK(crc == full);
+
+    // 增量更新与一次计算一致
+    CHECK(crc32_update(crc32_update(0, buf, 1000), buf + 1000, sizeof(buf) - 1000) == full);
+
+    return TEST_DONE("crc32");
+}
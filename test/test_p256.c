@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include "test.h"
+#include "p256.h"
+
+
+// openssl ecparam -name prime256v1 生成密钥，openssl dgst -sha256 -sign 签名并经openssl验证
+static const struct
+{
+    const char *pubkey;
+    const char *digest;
+    const char *sig;
+} vectors[] =
+{
+    {
+        "8e550aeee7ce18f3e5df2a1ffd7ddadb98ff0f28394f12b14ee7c5df6c000b91"
+        "976d03a6cf547e3981d13aaf21f195529993fecdaf2798eefae655e5fbc12cd3",
+        "028d9ac1e6cf799eb0616b4925d51855041422a4953649bbf14967e809de9efc",
+        "8057b59984ec278d7a6fbf237e749301474a6e3993f92bf8b7a3e0578e7fc226"
+        "73cd814d10992a7b27254c76c68df000645df7f37accdee15b9b324aac3f7ca1",
+    },
+    {
+        "34dd4f74a326891d5b9e35580c0e4e9988f36ef87b928120460ad1da12e026bb"
+        "e882a98758574ca6af58298ee0934763958e5d5e4967950724c48b47bf26a59a",
+        "afe9949a257ee48a05312315ddd49bd892610dad0f37cd8429b1aaf7d9e4d3e8",
+        "fdaefea7fc6e625c3e9050977a38b9ab91e5098192bd8d9a46c63ddb3a0b71e4"
+        "b38bfbe117b6c583e921c198ed3d4afa1c986631a8ec63229bdd931029fff417",
+    },
+    {
+        "648b2bd524062f8a9e64ac6a7bc80db8bc0f08cc0b20b56ac587b93c5b5e15a4"
+        "ff1e833e51aace05fa408389f56c78138779ac507c817e8597eae0333bd782e6",
+        "d69030eb19c4cc5605a76177b9c653728b22679e5bea4b65243ef1163f444f98",
+        "afbd85a6b77a025b5d09e9e89ffa132600c0b092de12f794d0ce8d3acdb82cdb"
+        "b287f7d2f5b428ac885ce9e3c361241c06e048b3adf28051f06721dbcf3cf2be",
+    },
+};
+
+// 域运算计数，由p256.c在P256_COUNT_OPS下累加
+uint32_t p256_count_mul, p256_count_add;
+
+/* 单次验签的运算次数上界，按p256.c的代码路径逐项相加：
+ * 乘法：公钥转换2 + 曲线检查3 + s转换1 + 模n求逆(256次平方 + n-2中169个1) + u1、u2 2
+ *       + 预计算点加16 + 256位 × (倍点8 + 点加16) + 模p求逆(256 + 128) + 仿射转换3 = 6980
+ * 加减：曲线检查5 + 预计算点加18 + 256位 × (倍点16 + 点加18) + 取模2 = 8729
+ * 点加在h、rr均为0时退化为倍点，乘法同为16次、加减18次，是单次点加的最坏情况
+ */
+#define VERIFY_MUL_MAX  6980
+#define VERIFY_ADD_MAX  8729
+
+static uint32_t worst_mul, worst_add;
+
+static bool counted_verify(const uint8_t *pubkey, const uint8_t *digest, const uint8_t *sig)
+{
+    p256_count_mul = 0;
+    p256_count_add = 0;
+    bool valid = p256_verify(pubkey, digest, sig);
+
+    if (p256_count_mul > worst_mul) worst_mul = p256_count_mul;
+    if (p256_count_add > worst_add) worst_add = p256_count_add;
+
+    return valid;
+}
+
+// 曲线阶n
+static const char *order = "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551";
+
+// vectors[0]的 (r, n - s)，ECDSA对s取负同样有效
+static const char *negated_s = "8c327eb1ef66d585d8dab38939720fff588902ba2c4abfa3981e98785023a8b0";
+
+
+int main(void)
+{
+    const size_t count = sizeof(vectors) / sizeof(vectors[0]);
+    uint8_t pubkey[P256_KEY_SIZE], digest[P256_DIGEST_SIZE], sig[P256_SIG_SIZE];
+    uint8_t t[P256_SIG_SIZE];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        unhex(vectors[i].pubkey, pubkey);
+        unhex(vectors[i].digest, digest);
+        unhex(vectors[i].sig, sig);
+
+        CHECK(counted_verify(pubkey, digest, sig));
+
+        // r、s、摘要、公钥任一位翻转都须拒绝
+        for (size_t bit = 0; bit < P256_SIG_SIZE * 8; bit += 37)
+        {
+            memcpy(t, sig, sizeof(t));
+            t[bit / 8] ^= 1 << (bit % 8);
+            CHECK(!counted_verify(pubkey, digest, t));
+        }
+        for (size_t bit = 0; bit < P256_DIGEST_SIZE * 8; bit += 29)
+        {
+            memcpy(t, digest, P256_DIGEST_SIZE);
+            t[bit / 8] ^= 1 << (bit % 8);
+            CHECK(!counted_verify(pubkey, t, sig));
+        }
+        for (size_t bit = 0; bit < P256_KEY_SIZE * 8; bit += 41)
+        {
+            // 翻转后的点不在曲线上
+            memcpy(t, pubkey, P256_KEY_SIZE);
+            t[bit / 8] ^= 1 << (bit % 8);
+            CHECK(!counted_verify(t, digest, sig));
+        }
+
+        // 换用其他密钥
+        unhex(vectors[(i + 1) % count].pubkey, t);
+        CHECK(!counted_verify(t, digest, sig));
+
+        // r、s 越界：0 与 n
+        memcpy(t, sig, sizeof(t));
+        memset(t, 0, 32);
+        CHECK(!counted_verify(pubkey, digest, t));
+        memcpy(t, sig, sizeof(t));
+        memset(t + 32, 0, 32);
+        CHECK(!counted_verify(pubkey, digest, t));
+        memcpy(t, sig, sizeof(t));
+        unhex(order, t);
+        CHECK(!counted_verify(pubkey, digest, t));
+        memcpy(t, sig, sizeof(t));
+        unhex(order, t + 32);
+        CHECK(!counted_verify(pubkey, digest, t));
+
+        // 坐标不小于p
+        memcpy(t, pubkey, P256_KEY_SIZE);
+        memset(t, 0xff, 32);
+        CHECK(!counted_verify(t, digest, sig));
+    }
+
+    unhex(vectors[0].pubkey, pubkey);
+    unhex(vectors[0].digest, digest);
+    unhex(vectors[0].sig, sig);
+    unhex(negated_s, sig + 32);
+    CHECK(counted_verify(pubkey, digest, sig));
+
+    CHECK(worst_mul <= VERIFY_MUL_MAX);
+    CHECK(worst_add <= VERIFY_ADD_MAX);
+    if (TEST_BENCH())
+    {
+        printf("p256_verify worst: %u mul, %u add/sub\n", worst_mul, worst_add);
+    }
+
+    return TEST_DONE("p256");
+}
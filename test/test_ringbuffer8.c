@@ -0,0 +1,314 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include "test.h"
+#include "ringbuffer8.h"
+
+
+#define RB_SIZE         64
+
+static uint32_t rb_buff[RB8_BUFFER_SIZE(RB_SIZE) / 4];
+
+
+// 以自由递增的序号作为数据，读出后可直接校验顺序
+static uint8_t next_in, next_out;
+
+static uint32_t put_seq(ringbuffer8_t rb, uint32_t size)
+{
+    uint8_t data[RB_SIZE * 2];
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        data[i] = next_in + i;
+    }
+    uint32_t n = rb8_puts(rb, data, size);
+    next_in += n;
+    return n;
+}
+
+static uint32_t get_seq(ringbuffer8_t rb, uint32_t size)
+{
+    uint8_t data[RB_SIZE * 2];
+    uint32_t n = rb8_gets(rb, data, size);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        CHECK(data[i] == (uint8_t)(next_out + i));
+    }
+    next_out += n;
+    return n;
+}
+
+
+// 批量读写：每个起始偏移、每种长度都跨过回绕点，与按字节计数的模型比对
+static void test_bulk(void)
+{
+    ringbuffer8_t rb = rb8_new((uint8_t *)rb_buff, sizeof(rb_buff));
+    rb8_stats_t stats;
+
+    CHECK(rb8_free(rb) == RB_SIZE);
+    CHECK(rb8_empty(rb));
+
+    for (uint32_t offset = 0; offset < RB_SIZE; offset++)
+    {
+        for (uint32_t size = 0; size <= RB_SIZE; size++)
+        {
+            CHECK(put_seq(rb, size) == size);
+            CHECK(rb8_count(rb) == size);
+            CHECK(rb8_full(rb) == (size == RB_SIZE));
+            CHECK(get_seq(rb, RB_SIZE * 2) == size);
+            CHECK(rb8_empty(rb));
+        }
+        // 读写位置前移一字节
+        CHECK(put_seq(rb, 1) == 1);
+        CHECK(get_seq(rb, 1) == 1);
+    }
+
+    rb8_stats(rb, &stats);
+    CHECK(stats.capacity == RB_SIZE);
+    CHECK(stats.peak == RB_SIZE);
+    CHECK(stats.overflows == 0);
+    CHECK(stats.dropped == 0);
+
+    // 空间不足时只写入能放下的部分，并计入溢出统计
+    CHECK(put_seq(rb, 40) == 40);
+    CHECK(put_seq(rb, 40) == RB_SIZE - 40);
+    CHECK(rb8_full(rb));
+    CHECK(put_seq(rb, 5) == 0);
+    CHECK(!rb8_put(rb, 0));
+    rb8_stats(rb, &stats);
+    CHECK(stats.overflows == 3);
+    CHECK(stats.dropped == (80 - RB_SIZE) + 5 + 1);
+
+    // 数据不足时只取出已有的部分
+    CHECK(get_seq(rb, 10) == 10);
+    CHECK(get_seq(rb, RB_SIZE) == RB_SIZE - 10);
+    CHECK(get_seq(rb, 1) == 0);
+
+    rb8_stats_clear(rb);
+    rb8_stats(rb, &stats);
+    CHECK(stats.peak == 0 && stats.overflows == 0 && stats.dropped == 0);
+
+    // 零拷贝：连续区止于缓存末尾，剩余部分从头开始
+    uint8_t *span;
+    CHECK(put_seq(rb, 13) == 13);
+    CHECK(get_seq(rb, 13) == 13);
+    uint32_t base = next_in & (RB_SIZE - 1);
+    CHECK(base != 0);
+    uint32_t n = rb8_reserve_span(rb, &span);
+    CHECK(n == RB_SIZE - base);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        span[i] = next_in++;
+    }
+    rb8_commit(rb, n);
+    CHECK(rb8_reserve_span(rb, &span) == base);
+    CHECK(put_seq(rb, base) == base);
+    CHECK(rb8_full(rb));
+
+    n = rb8_peek_span(rb, &span);
+    CHECK(n == RB_SIZE - base);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        CHECK(span[i] == (uint8_t)(next_out + i));
+    }
+    next_out += n;
+    rb8_consume(rb, n);
+    CHECK(rb8_count(rb) == base);
+    CHECK(get_seq(rb, RB_SIZE) == base);
+}
+
+
+// 线程间SPSC：写端与读端各自随机长度批量/单字节读写，读端校验序号连续
+#define SPSC_SIZE       512
+#define SPSC_BYTES      (4u << 20)
+
+static uint32_t spsc_buff[RB8_BUFFER_SIZE(SPSC_SIZE) / 4];
+
+static void *spsc_producer(void *arg)
+{
+    ringbuffer8_t rb = arg;
+    uint8_t data[SPSC_SIZE];
+    uint32_t seq = 0, seed = 1;
+
+    while (seq < SPSC_BYTES)
+    {
+        uint32_t size = (seed = seed * 1103515245 + 12345) >> 23;   // 0~511
+        uint32_t n;
+
+        if (size > SPSC_BYTES - seq)
+            size = SPSC_BYTES - seq;
+
+        if (size == 1)
+        {
+            n = rb8_put(rb, (uint8_t)seq);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < size; i++)
+            {
+                data[i] = (uint8_t)(seq + i);
+            }
+            n = rb8_puts(rb, data, size);
+        }
+        seq += n;
+        if (n < size)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *spsc_consumer(void *arg)
+{
+    ringbuffer8_t rb = arg;
+    uint8_t data[SPSC_SIZE];
+    uint32_t seq = 0, seed = 2;
+
+    while (seq < SPSC_BYTES)
+    {
+        uint32_t size = (seed = seed * 1103515245 + 12345) >> 23;
+        uint32_t n;
+        uint8_t *span;
+
+        switch (size & 3)
+        {
+        case 0:
+            n = rb8_get(rb, data);
+            break;
+        case 1:
+            n = rb8_peek_span(rb, &span);
+            if (n > size)
+                n = size;
+            memcpy(data, span, n);
+            rb8_consume(rb, n);
+            break;
+        default:
+            n = rb8_gets(rb, data, size);
+            break;
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (data[i] != (uint8_t)(seq + i))
+            {
+                CHECK(data[i] == (uint8_t)(seq + i));
+                return NULL;
+            }
+        }
+        seq += n;
+        if (n == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_spsc(void)
+{
+    ringbuffer8_t rb = rb8_new((uint8_t *)spsc_buff, sizeof(spsc_buff));
+    pthread_t producer, consumer;
+
+    pthread_create(&consumer, NULL, spsc_consumer, rb);
+    pthread_create(&producer, NULL, spsc_producer, rb);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    CHECK(rb8_empty(rb));
+}
+
+
+// 单线程吞吐：同样的数据分别以rb8_puts/rb8_gets与逐字节rb8_put/rb8_get的循环搬运，比较MB/s
+#define BENCH_RB_SIZE   512                 // 与BL_UART_BUFFER_SIZE一致
+#define BENCH_BYTES     (1u << 26)
+
+static uint32_t bench_buff[RB8_BUFFER_SIZE(BENCH_RB_SIZE) / 4];
+
+static uint64_t bench_bulk(uint32_t chunk, uint32_t *sum)
+{
+    ringbuffer8_t rb = rb8_new((uint8_t *)bench_buff, sizeof(bench_buff));
+    uint8_t in[BENCH_RB_SIZE], out[BENCH_RB_SIZE];
+    uint64_t t0;
+
+    for (uint32_t i = 0; i < chunk; i++)
+    {
+        in[i] = (uint8_t)i;
+    }
+
+    t0 = test_ns();
+    for (uint32_t n = 0; n < BENCH_BYTES; n += chunk)
+    {
+        rb8_puts(rb, in, chunk);
+        uint32_t got = rb8_gets(rb, out, chunk);
+        for (uint32_t i = 0; i < got; i++)
+        {
+            *sum += out[i];
+        }
+    }
+    return test_ns() - t0;
+}
+
+static uint64_t bench_bytewise(uint32_t chunk, uint32_t *sum)
+{
+    ringbuffer8_t rb = rb8_new((uint8_t *)bench_buff, sizeof(bench_buff));
+    uint8_t in[BENCH_RB_SIZE], out[BENCH_RB_SIZE];
+    uint64_t t0;
+
+    for (uint32_t i = 0; i < chunk; i++)
+    {
+        in[i] = (uint8_t)i;
+    }
+
+    t0 = test_ns();
+    for (uint32_t n = 0; n < BENCH_BYTES; n += chunk)
+    {
+        uint32_t put = 0, got = 0;
+
+        while (put < chunk && rb8_put(rb, in[put]))
+        {
+            put++;
+        }
+        while (got < chunk && rb8_get(rb, &out[got]))
+        {
+            got++;
+        }
+        for (uint32_t i = 0; i < got; i++)
+        {
+            *sum += out[i];
+        }
+    }
+    return test_ns() - t0;
+}
+
+static void bench_throughput(void)
+{
+    static const uint32_t chunks[] = { 8, 64, 256 };
+
+    for (uint32_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++)
+    {
+        uint32_t sum_bulk = 0, sum_byte = 0;
+        uint64_t t_bulk = bench_bulk(chunks[c], &sum_bulk);
+        uint64_t t_byte = bench_bytewise(chunks[c], &sum_byte);
+
+        // 两种方式搬运的数据须一致，求和同时防止循环被优化掉
+        CHECK(sum_bulk == sum_byte);
+
+        if (TEST_BENCH())
+        {
+            printf("rb8 chunk %3u: puts/gets %7.1f MB/s, put/get loop %7.1f MB/s\n", chunks[c],
+                   BENCH_BYTES * 1e3 / t_bulk, BENCH_BYTES * 1e3 / t_byte);
+        }
+    }
+}
+
+
+int main(void)
+{
+    test_bulk();
+    test_spsc();
+    bench_throughput();
+
+    return TEST_DONE("ringbuffer8");
+}
@@ -0,0 +1,250 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include "test.h"
+#include "ringqueue.h"
+
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t check;
+} item_t;
+
+#define ITEM_CHECK(s)   ((s) * 2654435761u)
+
+RQ_DEFINE(itemq, item_t, 8)
+RQ_DEFINE(ptrq, uint8_t *, 4)         // 指针元素，push参数为 uint8_t *const *
+
+
+static void test_batch(void)
+{
+    static itemq_t q;
+    item_t in[12], out[12];
+    uint32_t seq = 0, expect = 0;
+
+    itemq_init(&q);
+    CHECK(itemq_empty(&q) && itemq_free(&q) == 8);
+    CHECK(itemq_peek(&q) == NULL);
+
+    // 每轮写入不同批量，读出后校验，覆盖各回绕位置
+    for (uint32_t round = 0; round < 64; round++)
+    {
+        uint32_t n = round % 12;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            in[i].seq = seq + i;
+            in[i].check = ITEM_CHECK(seq + i);
+        }
+        uint32_t pushed = itemq_push_n(&q, in, n);
+        CHECK(pushed == (n < 8 ? n : 8));
+        CHECK(itemq_count(&q) == pushed);
+        CHECK(itemq_full(&q) == (pushed == 8));
+        seq += pushed;
+
+        if (pushed)
+        {
+            CHECK(itemq_peek(&q)->seq == expect);
+        }
+        uint32_t popped = itemq_pop_n(&q, out, 12);
+        CHECK(popped == pushed);
+        for (uint32_t i = 0; i < popped; i++)
+        {
+            CHECK(out[i].seq == expect && out[i].check == ITEM_CHECK(expect));
+            expect++;
+        }
+        CHECK(itemq_empty(&q));
+    }
+
+    // 单个读写与满/空
+    item_t item = { 0, 0 };
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        item.seq = i;
+        CHECK(itemq_push(&q, &item));
+    }
+    CHECK(!itemq_push(&q, &item));
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        CHECK(itemq_pop(&q, &item) && item.seq == i);
+    }
+    CHECK(!itemq_pop(&q, &item));
+
+    static ptrq_t pq;
+    uint8_t bytes[4], *p = NULL;
+    ptrq_init(&pq);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint8_t *b = &bytes[i];
+        CHECK(ptrq_push(&pq, &b));
+    }
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK(ptrq_pop(&pq, &p) && p == &bytes[i]);
+    }
+}
+
+
+// 线程间SPSC：写端与读端交替使用单个与批量接口，读端校验序号与校验值
+#define SPSC_ITEMS      (1u << 20)
+
+static itemq_t spsc_q;
+
+static void *spsc_producer(void *arg)
+{
+    item_t batch[5];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < SPSC_ITEMS)
+    {
+        uint32_t n = (seq & 1) ? 1 : 5;
+        if (n > SPSC_ITEMS - seq)
+            n = SPSC_ITEMS - seq;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            batch[i].seq = seq + i;
+            batch[i].check = ITEM_CHECK(seq + i);
+        }
+        uint32_t done = n == 1 ? itemq_push(&spsc_q, batch) : itemq_push_n(&spsc_q, batch, n);
+        seq += done;
+        if (done < n)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *spsc_consumer(void *arg)
+{
+    item_t batch[3];
+    uint32_t seq = 0;
+
+    (void)arg;
+    while (seq < SPSC_ITEMS)
+    {
+        uint32_t n;
+
+        if (seq % 3 == 0)
+        {
+            // peek看到的元素须与随后pop取出的相同
+            item_t *head = itemq_peek(&spsc_q);
+            n = 0;
+            if (head)
+            {
+                uint32_t peeked = head->seq;
+                n = itemq_pop(&spsc_q, batch);
+                CHECK(n == 1 && batch[0].seq == peeked);
+            }
+        }
+        else
+        {
+            n = itemq_pop_n(&spsc_q, batch, 3);
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (batch[i].seq != seq + i || batch[i].check != ITEM_CHECK(seq + i))
+            {
+                CHECK(batch[i].seq == seq + i && batch[i].check == ITEM_CHECK(seq + i));
+                return NULL;
+            }
+        }
+        seq += n;
+        if (n == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_spsc(void)
+{
+    pthread_t producer, consumer;
+
+    itemq_init(&spsc_q);
+    pthread_create(&consumer, NULL, spsc_consumer, NULL);
+    pthread_create(&producer, NULL, spsc_producer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    CHECK(itemq_empty(&spsc_q));
+}
+
+
+// 单线程吞吐：逐个push/pop与按批push_n/pop_n各搬运BENCH_ITEMS个元素，比较每元素耗时
+#define BENCH_ITEMS     (1u << 24)
+#define BENCH_BATCH     16u
+
+RQ_DEFINE(benchq, item_t, 64)
+
+static void bench_throughput(void)
+{
+    static benchq_t q;
+    item_t batch[BENCH_BATCH];
+    uint32_t sum_single = 0, sum_batch = 0;
+    uint64_t t0, t_single, t_batch;
+
+    for (uint32_t i = 0; i < BENCH_BATCH; i++)
+    {
+        batch[i].seq = i;
+        batch[i].check = ITEM_CHECK(i);
+    }
+
+    benchq_init(&q);
+    t0 = test_ns();
+    for (uint32_t n = 0; n < BENCH_ITEMS; n += BENCH_BATCH)
+    {
+        for (uint32_t i = 0; i < BENCH_BATCH; i++)
+        {
+            benchq_push(&q, &batch[i]);
+        }
+        for (uint32_t i = 0; i < BENCH_BATCH; i++)
+        {
+            item_t item;
+            if (benchq_pop(&q, &item))
+            {
+                sum_single += item.seq;
+            }
+        }
+    }
+    t_single = test_ns() - t0;
+
+    benchq_init(&q);
+    t0 = test_ns();
+    for (uint32_t n = 0; n < BENCH_ITEMS; n += BENCH_BATCH)
+    {
+        item_t out[BENCH_BATCH];
+
+        benchq_push_n(&q, batch, BENCH_BATCH);
+        benchq_pop_n(&q, out, BENCH_BATCH);
+        for (uint32_t i = 0; i < BENCH_BATCH; i++)
+        {
+            sum_batch += out[i].seq;
+        }
+    }
+    t_batch = test_ns() - t0;
+
+    // 求和同时防止循环被优化掉
+    CHECK(sum_single == sum_batch && benchq_empty(&q));
+
+    if (TEST_BENCH())
+    {
+        printf("ringqueue push/pop     %.2f ns/item\n", (double)t_single / BENCH_ITEMS);
+        printf("ringqueue push_n/pop_n %.2f ns/item (batch %u)\n", (double)t_batch / BENCH_ITEMS, BENCH_BATCH);
+    }
+}
+
+
+int main(void)
+{
+    test_batch();
+    test_spsc();
+    bench_throughput();
+
+    return TEST_DONE("ringqueue");
+}
@@ -0,0 +1,78 @@
+#include <stdint.h>
+#include "test.h"
+#include "sha256.h"
+
+
+// FIPS 180-4 / NIST CSRC 示例向量
+static const struct
+{
+    const char *msg;
+    uint32_t repeat;
+    const char *digest;
+} vectors[] =
+{
+    { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+      "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+    { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+};
+
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        uint8_t expect[SHA256_DIGEST_SIZE], digest[SHA256_DIGEST_SIZE];
+        uint32_t len = strlen(vectors[i].msg);
+        sha256_ctx_t ctx;
+
+        unhex(vectors[i].digest, expect);
+
+        sha256_init(&ctx);
+        for (uint32_t r = 0; r < vectors[i].repeat; r++)
+        {
+            sha256_update(&ctx, (const uint8_t *)vectors[i].msg, len);
+        }
+        sha256_final(&ctx, digest);
+        CHECK_MEM(digest, expect, SHA256_DIGEST_SIZE);
+
+        if (vectors[i].repeat == 1)
+        {
+            sha256((const uint8_t *)vectors[i].msg, len, digest);
+            CHECK_MEM(digest, expect, SHA256_DIGEST_SIZE);
+        }
+    }
+
+    // 任意分段输入与一次输入结果一致，覆盖跨块边界的缓存路径
+    static uint8_t buf[5000];
+    uint8_t once[SHA256_DIGEST_SIZE], split[SHA256_DIGEST_SIZE];
+
+    srand(2);
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+    sha256(buf, sizeof(buf), once);
+
+    for (int round = 0; round < 200; round++)
+    {
+        sha256_ctx_t ctx;
+        uint32_t off = 0;
+
+        sha256_init(&ctx);
+        while (off < sizeof(buf))
+        {
+            uint32_t n = rand() % 150;
+            if (n > sizeof(buf) - off) n = sizeof(buf) - off;
+            sha256_update(&ctx, buf + off, n);
+            off += n;
+        }
+        sha256_final(&ctx, split);
+        CHECK_MEM(split, once, SHA256_DIGEST_SIZE);
+    }
+
+    return TEST_DONE("sha256");
+}